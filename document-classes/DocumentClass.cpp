@@ -32,8 +32,9 @@ DocumentClass::DocumentClass():
 { Debug::Throw( QStringLiteral("DocumentClass::DocumentClass.\n") ); }
 
 //________________________________________________________
-DocumentClass::DocumentClass( const QDomElement& element ):
-    Counter( QStringLiteral("DocumentClass") )
+DocumentClass::DocumentClass( const QDomElement& element, Mode mode ):
+    Counter( QStringLiteral("DocumentClass") ),
+    loaded_( mode == Mode::All )
 {
     Debug::Throw( QStringLiteral("DocumentClass::DocumentClass.\n") );
 
@@ -62,11 +63,15 @@ DocumentClass::DocumentClass( const QDomElement& element ):
     }
 
     // parse children
+    HighlightPattern::List patterns;
     for( auto&& childNode = element.firstChild(); !childNode.isNull(); childNode = childNode.nextSibling() )
     {
         const auto childElement = childNode.toElement();
         if( childElement.isNull() ) continue;
 
+        // only options are needed for header
+        if( !loaded_ && childElement.tagName() != Base::Xml::Option ) continue;
+
         if( childElement.tagName() == Xml::Style )
         {
 
@@ -76,7 +81,8 @@ DocumentClass::DocumentClass( const QDomElement& element ):
         } else if( childElement.tagName() == Xml::KeywordPattern || childElement.tagName() == Xml::RangePattern ) {
 
             HighlightPattern pattern( childElement );
-            if( pattern.isValid() ) highlightPatterns_.append( pattern );
+            if( pattern.isValid() ) patterns.append( pattern );
+            else warnings_ << QString( QObject::tr( "Highlight pattern %1 is invalid" ) ).arg( pattern.name() );
 
         } else if( childElement.tagName() == Xml::IndentPattern ) {
 
@@ -113,11 +119,19 @@ DocumentClass::DocumentClass( const QDomElement& element ):
 
     }
 
+    // patterns are associated and compiled when all content is parsed
+    if( !loaded_ ) return;
+
     // associate elements
-    const auto warnings = _associatePatterns();
+    warnings_.append( _associatePatterns( patterns ) );
+    auto warnings( warnings_ );
+    warnings.append( _checkPatterns( patterns ) );
     for( const auto& warning:warnings )
     { Debug::Throw(0) << "DocumentClass::DocumentClass - " << warning << Qt::endl; }
 
+    // compile patterns and merge keyword patterns, once for all displays
+    highlightPatterns_ = std::make_shared<const HighlightPatternSet>( patterns );
+
 }
 
 //______________________________________________________
@@ -145,42 +159,68 @@ bool operator == ( const DocumentClass& first, const DocumentClass& second )
 }
 
 //______________________________________________________
-QStringList DocumentClass::_associatePatterns()
+QStringList DocumentClass::_associatePatterns( HighlightPattern::List& patterns )
 {
 
     Debug::Throw( QStringLiteral("DocumentClass::_associatePatterns.\n") );
     QStringList out;
 
     // assign pattern ids
-    // warning: the passed Id is converted internaly into a single bit of a bitset
-    // to facilitate patterns bitMask
+    // ids are dense and start from 1, so that 0 means 'no pattern'
+    // this allows to use them directly as index in active pattern bit arrays
     int id(0);
-    for( auto& highlightPattern:highlightPatterns_ )
-    { highlightPattern.setId( id++ ); }
+    for( auto& highlightPattern:patterns )
+    { highlightPattern.setId( ++id ); }
+
+    // create style table
+    highlightStyleTable_ = highlightStyles_.values();
+    std::sort( highlightStyleTable_.begin(), highlightStyleTable_.end(), HighlightStyle::WeakLessThanFTor() );
+
+    // assign styles to patterns
+    for( auto& pattern:patterns )
+    {
+        auto styleIter( std::find_if( highlightStyleTable_.begin(), highlightStyleTable_.end(), HighlightStyle::SameNameFTor( pattern.style() ) ) );
+        if( styleIter != highlightStyleTable_.end() )
+        {
+            pattern.setStyle( *styleIter );
+            pattern.setStyleIndex( std::distance( highlightStyleTable_.begin(), styleIter ) );
+        } else out << QString( QObject::tr( "Unable to find highlight style named %1" ) ).arg( pattern.style().name() );
+    }
 
     // create parent/children hierarchy between highlight patterns
-    for( auto& highlightPattern:highlightPatterns_ )
+    for( auto& highlightPattern:patterns )
     {
         if( !highlightPattern.parent().isEmpty() )
         {
 
-            auto parentIter( std::find_if( highlightPatterns_.begin(), highlightPatterns_.end(), HighlightPattern::SameNameFTor( highlightPattern.parent() ) ) );
-            if( parentIter != highlightPatterns_.end() )
+            auto parentIter( std::find_if( patterns.begin(), patterns.end(), HighlightPattern::SameNameFTor( highlightPattern.parent() ) ) );
+            if( parentIter != patterns.end() )
             {
                 highlightPattern.setParentId( parentIter->id() );
-                parentIter->addChild( highlightPattern );
+                parentIter->addChild( highlightPattern.id() );
             } else out << QString( QObject::tr( "Unable to find highlight pattern named %1" ) ).arg( highlightPattern.parent() );
 
         }
 
     }
 
-    // assign styles to patterns
-    for( auto& pattern:highlightPatterns_ )
+    return out;
+
+}
+
+//______________________________________________________
+QStringList DocumentClass::_checkPatterns( const HighlightPattern::List& patterns ) const
+{
+
+    Debug::Throw( QStringLiteral("DocumentClass::_checkPatterns.\n") );
+    QStringList out;
+
+    // such patterns can take exponential time on long lines.
+    // They still get highlighted, within a budget of matching steps per block
+    for( const auto& pattern:patterns )
     {
-        auto styleIter( std::find_if( highlightStyles_.begin(), highlightStyles_.end(), HighlightStyle::SameNameFTor( pattern.style() ) ) );
-        if( styleIter != highlightStyles_.end() ) pattern.setStyle( *styleIter );
-        else out << QString( QObject::tr( "Unable to find highlight style named %1" ) ).arg( pattern.style().name() );
+        if( pattern.isBacktrackingProne() )
+        { out << QString( QObject::tr( "Highlight pattern %1 contains nested quantifiers and may be slow on long lines" ) ).arg( pattern.name() ); }
     }
 
     return out;
@@ -222,7 +262,7 @@ QDomElement DocumentClass::domElement( QDomDocument& parent ) const
     // dump highlight patterns
     out.appendChild( parent.createTextNode( QStringLiteral("\n\n") ) );
     out.appendChild( parent.createComment( QObject::tr( "Highlight patterns" ) ) );
-    for( const auto& pattern:highlightPatterns_ )
+    for( const auto& pattern:highlightPatterns() )
     { out.appendChild( pattern.domElement( parent ) ); }
 
     // dump indent patterns
@@ -262,29 +302,41 @@ bool DocumentClass::match( const File& file ) const
     if( default_ ) { return true; }
 
     // check if file pattern match
-    if( !filePattern_.pattern().isEmpty() && filePattern_.isValid() && file.contains( filePattern_ ) )
-    { return true; }
+    if( matchFileName( file ) ) return true;
 
     // check if first line of file match firstlinePattern_
+    return hasFirstLinePattern() && matchFirstLine( firstLine( file ) );
+
+}
+
+//________________________________________________________
+bool DocumentClass::matchFileName( const File& file ) const
+{ return !filePattern_.pattern().isEmpty() && filePattern_.isValid() && file.contains( filePattern_ ); }
+
+//________________________________________________________
+bool DocumentClass::matchFirstLine( const QString& line ) const
+{ return !line.isEmpty() && hasFirstLinePattern() && firstlinePattern_.match( line ).hasMatch(); }
+
+//________________________________________________________
+QString DocumentClass::firstLine( const File& file )
+{
+
     QFile in( file );
-    if( !firstlinePattern_.pattern().isEmpty() && firstlinePattern_.isValid() && in.open( QIODevice::ReadOnly ) )
-    {
+    if( !in.open( QIODevice::ReadOnly ) ) return QString();
 
-        QString line;
-        static const QRegularExpression emptyLineRegexp( QStringLiteral("(^\\s*$)") );
-        while( in.bytesAvailable() && !(line = in.readLine(1024)).isNull() )
-        {
+    QString line;
+    static const QRegularExpression emptyLineRegexp( QStringLiteral("(^\\s*$)") );
+    while( in.bytesAvailable() && !(line = in.readLine(1024)).isNull() )
+    {
 
-            // skip empty lines
-            if( line.isEmpty() || emptyLineRegexp.match( line ).hasMatch() )
-            { continue; }
+        // skip empty lines
+        if( line.isEmpty() || emptyLineRegexp.match( line ).hasMatch() )
+        { continue; }
 
-            // check non empty lines
-            return ( firstlinePattern_.match( line ).hasMatch() );
+        return line;
 
-        }
     }
 
-    // no match
-    return false;
+    // no non empty line
+    return QString();
 }
@@ -26,6 +26,7 @@
 #include "File.h"
 #include "Functors.h"
 #include "HighlightPattern.h"
+#include "HighlightPatternSet.h"
 #include "HighlightStyle.h"
 #include "IndentPattern.h"
 #include "TextMacro.h"
@@ -46,8 +47,19 @@ class DocumentClass final: private Base::Counter<DocumentClass>
     //* constructor
     explicit DocumentClass();
 
+    //* parsing mode
+    enum class Mode
+    {
+        //* all class content
+        All,
+
+        //* only what is needed to list and match classes
+        /** name, file and first line patterns, icon and options */
+        Header
+    };
+
     //* constructor
-    explicit DocumentClass( const QDomElement& );
+    explicit DocumentClass( const QDomElement&, Mode = Mode::All );
 
     //* write to DomElement
     QDomElement domElement( QDomDocument& parent ) const;
@@ -63,6 +75,10 @@ class DocumentClass final: private Base::Counter<DocumentClass>
     const File& file() const
     { return file_; }
 
+    //* stamp identifying the state of the file, when the class was read
+    const QByteArray& fileStamp() const
+    { return fileStamp_; }
+
     //* icon name
     const QString& icon() const
     { return icon_; }
@@ -75,6 +91,10 @@ class DocumentClass final: private Base::Counter<DocumentClass>
     bool isBuildIn() const
     { return buildIn_; }
 
+    //* true if all content has been parsed
+    bool isLoaded() const
+    { return loaded_; }
+
     //* filename matching pattern
     const QRegularExpression& fileMatchingPattern() const
     { return filePattern_; }
@@ -86,6 +106,19 @@ class DocumentClass final: private Base::Counter<DocumentClass>
     //* return true if document class match filename
     bool match( const File& file ) const;
 
+    //* return true if file name matches file pattern
+    bool matchFileName( const File& ) const;
+
+    //* return true if line matches first line pattern
+    bool matchFirstLine( const QString& ) const;
+
+    //* true if first line pattern is set and valid
+    bool hasFirstLinePattern() const
+    { return !firstlinePattern_.pattern().isEmpty() && firstlinePattern_.isValid(); }
+
+    //* first non empty line of a file, as matched against first line patterns
+    static QString firstLine( const File& );
+
     //* returns true if document class enables wrapping by default
     bool wrap() const
     { return wrap_; }
@@ -102,8 +135,18 @@ class DocumentClass final: private Base::Counter<DocumentClass>
     const HighlightStyle::Set& highlightStyles() const
     { return highlightStyles_; }
 
+    //* hightlight style table
+    /** styles sorted by name. Patterns and pattern locations refer to styles by their index in this table */
+    const HighlightStyle::List& highlightStyleTable() const
+    { return highlightStyleTable_; }
+
     //* highligh patterns
     const HighlightPattern::List& highlightPatterns() const
+    { return highlightPatterns_->patterns(); }
+
+    //* compiled highlight patterns
+    /** they are shared by all copies of the class, and all highlighters using it */
+    const HighlightPatternSet::Pointer& highlightPatternSet() const
     { return highlightPatterns_; }
 
     //* list of indentation patterns
@@ -132,6 +175,11 @@ class DocumentClass final: private Base::Counter<DocumentClass>
     const TextMacro::List& textMacros() const
     { return textMacros_; }
 
+    //* errors found when parsing all content
+    /** invalid highlight patterns, and missing styles or parent patterns */
+    const QStringList& warnings() const
+    { return warnings_; }
+
     //@}
 
     //*@name modifiers
@@ -145,6 +193,10 @@ class DocumentClass final: private Base::Counter<DocumentClass>
     void setFile( const File& file )
     { file_ = file; }
 
+    //* set file stamp
+    void setFileStamp( const QByteArray& value )
+    { fileStamp_ = value; }
+
     //* default
     void setIsDefault( bool value )
     { default_ = value; }
@@ -207,7 +259,11 @@ class DocumentClass final: private Base::Counter<DocumentClass>
 
     //* perform associations between highlight patterns and highlight styles
     /** returns list of warnings if any */
-    QStringList _associatePatterns();
+    QStringList _associatePatterns( HighlightPattern::List& );
+
+    //* check highlight patterns for constructs prone to catastrophic backtracking
+    /** returns list of warnings if any */
+    QStringList _checkPatterns( const HighlightPattern::List& ) const;
 
     private:
 
@@ -217,6 +273,9 @@ class DocumentClass final: private Base::Counter<DocumentClass>
     //* parent file
     File file_;
 
+    //* parent file stamp
+    QByteArray fileStamp_;
+
     //* file pattern
     QRegularExpression filePattern_;
 
@@ -230,6 +289,9 @@ class DocumentClass final: private Base::Counter<DocumentClass>
     //* is class build-in
     bool buildIn_ = false;
 
+    //* true if all content has been parsed
+    bool loaded_ = true;
+
     //* wrap flag
     bool wrap_ = false;
 
@@ -245,8 +307,11 @@ class DocumentClass final: private Base::Counter<DocumentClass>
     //* set of highlight styles
     HighlightStyle::Set highlightStyles_;
 
-    //* list of highlight patterns
-    HighlightPattern::List highlightPatterns_;
+    //* indexed highlight styles
+    HighlightStyle::List highlightStyleTable_;
+
+    //* compiled highlight patterns
+    HighlightPatternSet::Pointer highlightPatterns_ = HighlightPatternSet::emptySet();
 
     //* list of indentation patterns
     IndentPattern::List indentPatterns_;
@@ -266,6 +331,9 @@ class DocumentClass final: private Base::Counter<DocumentClass>
     */
     int baseIndentation_ = 0;
 
+    //* parsing errors
+    QStringList warnings_;
+
 };
 
 //* strict equal to operator
@@ -0,0 +1,256 @@
+/******************************************************************************
+*
+* Copyright (C) 2002 Hugo PEREIRA <mailto: hugo.pereira@free.fr>
+*
+* This is free software; you can redistribute it and/or modify it under the
+* terms of the GNU General Public License as published by the Free Software
+* Foundation; either version 2 of the License, or (at your option) any later
+* version.
+*
+* This software is distributed in the hope that it will be useful, but WITHOUT
+* Any WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along with
+* this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*******************************************************************************/
+
+#include "DocumentClassCache.h"
+#include "Debug.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+
+namespace
+{
+    //* magic number, written at the beginning of the cache file
+    const quint32 magic = 0x71656463;
+
+    //* format version, to be incremented whenever the format changes
+    const quint32 version = 1;
+
+    //* node types
+    enum NodeType: quint8
+    {
+        Element,
+        Text
+    };
+}
+
+//________________________________________________________
+DocumentClassCache::DocumentClassCache():
+    Counter( QStringLiteral("DocumentClassCache") )
+{}
+
+//________________________________________________________
+void DocumentClassCache::setFile( const File& file )
+{
+    Debug::Throw() << "DocumentClassCache::setFile - file: " << file << Qt::endl;
+    if( file == file_ ) return;
+
+    file_ = file;
+    entries_.clear();
+    used_.clear();
+    modified_ = false;
+
+    QFile in( file_ );
+    if( !in.open( QIODevice::ReadOnly ) ) return;
+
+    QDataStream stream( &in );
+    stream.setVersion( QDataStream::Qt_5_6 );
+
+    quint32 fileMagic = 0;
+    quint32 fileVersion = 0;
+    stream >> fileMagic >> fileVersion;
+    if( fileMagic != magic || fileVersion != version ) return;
+
+    quint32 count = 0;
+    stream >> count;
+    for( quint32 index = 0; index < count && stream.status() == QDataStream::Ok; ++index )
+    {
+        QString path;
+        Entry entry;
+        stream >> path >> entry.stamp_ >> entry.data_;
+        if( stream.status() == QDataStream::Ok ) entries_.insert( path, entry );
+    }
+
+    // discard everything if the file is corrupted
+    if( stream.status() != QDataStream::Ok ) entries_.clear();
+
+}
+
+//________________________________________________________
+bool DocumentClassCache::find( const File& file, QDomDocument& document )
+{
+
+    if( file_.isEmpty() ) return false;
+    used_.insert( file );
+
+    const auto iter( entries_.constFind( file ) );
+    if( iter == entries_.constEnd() || iter->stamp_ != stamp( file ) ) return false;
+
+    QDataStream stream( iter->data_ );
+    stream.setVersion( QDataStream::Qt_5_6 );
+
+    QDomDocument out;
+    out.appendChild( _read( stream, out ) );
+    if( stream.status() != QDataStream::Ok || out.documentElement().isNull() ) return false;
+
+    Debug::Throw() << "DocumentClassCache::find - found: " << file << Qt::endl;
+    document = out;
+    return true;
+
+}
+
+//________________________________________________________
+void DocumentClassCache::insert( const File& file, const QDomDocument& document )
+{
+
+    if( file_.isEmpty() ) return;
+
+    Entry entry;
+    entry.stamp_ = stamp( file );
+    if( entry.stamp_.isEmpty() ) return;
+
+    QDataStream stream( &entry.data_, QIODevice::WriteOnly );
+    stream.setVersion( QDataStream::Qt_5_6 );
+    _write( stream, document.documentElement() );
+
+    entries_.insert( file, entry );
+    used_.insert( file );
+    modified_ = true;
+
+}
+
+//________________________________________________________
+bool DocumentClassCache::write( bool prune )
+{
+
+    // discard entries of files that are not used anymore
+    if( prune )
+    {
+        for( auto iter = entries_.begin(); iter != entries_.end(); )
+        {
+            if( used_.contains( iter.key() ) ) ++iter;
+            else {
+                iter = entries_.erase( iter );
+                modified_ = true;
+            }
+        }
+
+        used_.clear();
+    }
+
+    if( !modified_ || file_.isEmpty() ) return true;
+    Debug::Throw() << "DocumentClassCache::write - file: " << file_ << " entries: " << entries_.size() << Qt::endl;
+
+    // make sure path exists
+    QDir path( QFileInfo( file_ ).path() );
+    if( !( path.exists() || path.mkpath( QStringLiteral(".") ) ) ) return false;
+
+    QFile out( file_ );
+    if( !out.open( QIODevice::WriteOnly ) ) return false;
+
+    QDataStream stream( &out );
+    stream.setVersion( QDataStream::Qt_5_6 );
+    stream << magic << version << quint32( entries_.size() );
+    for( auto iter = entries_.constBegin(); iter != entries_.constEnd(); ++iter )
+    { stream << iter.key() << iter->stamp_ << iter->data_; }
+
+    modified_ = false;
+    return stream.status() == QDataStream::Ok;
+
+}
+
+//________________________________________________________
+QByteArray DocumentClassCache::stamp( const File& file )
+{
+
+    const QFileInfo fileInfo( file );
+    if( !fileInfo.exists() ) return QByteArray();
+
+    // modification time and size
+    const auto lastModified( fileInfo.lastModified() );
+    if( lastModified.isValid() )
+    { return QByteArray::number( lastModified.toMSecsSinceEpoch() ) + '-' + QByteArray::number( fileInfo.size() ); }
+
+    // content
+    QFile in( file );
+    if( !in.open( QIODevice::ReadOnly ) ) return QByteArray();
+    return QCryptographicHash::hash( in.readAll(), QCryptographicHash::Sha1 );
+
+}
+
+//________________________________________________________
+void DocumentClassCache::_write( QDataStream& stream, const QDomElement& element )
+{
+
+    stream << element.tagName();
+
+    // attributes
+    const auto attributes( element.attributes() );
+    stream << quint32( attributes.count() );
+    for( int i = 0; i < attributes.count(); ++i )
+    {
+        const auto attribute( attributes.item( i ).toAttr() );
+        stream << attribute.name() << attribute.value();
+    }
+
+    // children. Comments and processing instructions are skipped
+    QList<QDomNode> children;
+    for( auto node = element.firstChild(); !node.isNull(); node = node.nextSibling() )
+    { if( node.isElement() || node.isText() ) children.append( node ); }
+
+    stream << quint32( children.size() );
+    for( const auto& node:children )
+    {
+        if( node.isElement() )
+        {
+            stream << quint8( Element );
+            _write( stream, node.toElement() );
+        } else stream << quint8( Text ) << node.toText().data();
+    }
+
+}
+
+//________________________________________________________
+QDomElement DocumentClassCache::_read( QDataStream& stream, QDomDocument& document )
+{
+
+    QString tagName;
+    stream >> tagName;
+    auto element( document.createElement( tagName ) );
+
+    // attributes
+    quint32 count = 0;
+    stream >> count;
+    for( quint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i )
+    {
+        QString name;
+        QString value;
+        stream >> name >> value;
+        element.setAttribute( name, value );
+    }
+
+    // children
+    stream >> count;
+    for( quint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i )
+    {
+        quint8 type = 0;
+        stream >> type;
+        if( type == Element ) element.appendChild( _read( stream, document ) );
+        else {
+            QString text;
+            stream >> text;
+            element.appendChild( document.createTextNode( text ) );
+        }
+    }
+
+    return element;
+
+}
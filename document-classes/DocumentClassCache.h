@@ -0,0 +1,99 @@
+#ifndef DocumentClassCache_h
+#define DocumentClassCache_h
+
+/******************************************************************************
+*
+* Copyright (C) 2002 Hugo PEREIRA <mailto: hugo.pereira@free.fr>
+*
+* This is free software; you can redistribute it and/or modify it under the
+* terms of the GNU General Public License as published by the Free Software
+* Foundation; either version 2 of the License, or (at your option) any later
+* version.
+*
+* This software is distributed in the hope that it will be useful, but WITHOUT
+* Any WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along with
+* this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*******************************************************************************/
+#include "Counter.h"
+#include "File.h"
+
+#include <QByteArray>
+#include <QDataStream>
+#include <QDomDocument>
+#include <QDomElement>
+#include <QHash>
+#include <QSet>
+
+//* parsed document class files, stored in binary form
+/**
+the element tree of each pattern file is stored once parsed, keyed by the file path, modification time and size,
+so that document classes are rebuilt without parsing xml as long as the file is unchanged.
+Files with no valid modification time, such as built-in ones, are keyed by a hash of their content instead.
+Entries of files that were not read since the last pruning write are discarded when writing with pruning enabled
+*/
+class DocumentClassCache final: private Base::Counter<DocumentClassCache>
+{
+
+    public:
+
+    //* constructor
+    explicit DocumentClassCache();
+
+    //* cache file
+    /** entries are read from the file, if valid */
+    void setFile( const File& );
+
+    //* retrieve document matching a given pattern file. Returns false if not found or outdated
+    bool find( const File&, QDomDocument& );
+
+    //* store document for a given pattern file
+    void insert( const File&, const QDomDocument& );
+
+    //* write entries to cache file, if changed
+    /** when prune is true, entries of files that were not read since the last pruning write are discarded */
+    bool write( bool prune = true );
+
+    //* stamp identifying the state of a given pattern file
+    /** it is empty if the file does not exist */
+    static QByteArray stamp( const File& );
+
+    private:
+
+    //* write element tree
+    static void _write( QDataStream&, const QDomElement& );
+
+    //* read element tree
+    static QDomElement _read( QDataStream&, QDomDocument& );
+
+    //* entry
+    class Entry
+    {
+        public:
+
+        //* stamp
+        QByteArray stamp_;
+
+        //* serialized element tree
+        QByteArray data_;
+    };
+
+    //* cache file
+    File file_;
+
+    //* entries, indexed by pattern file
+    QHash<QString, Entry> entries_;
+
+    //* pattern files accessed since last pruning write
+    QSet<QString> used_;
+
+    //* true if entries changed since last write
+    bool modified_ = false;
+
+};
+
+#endif
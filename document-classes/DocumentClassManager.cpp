@@ -27,6 +27,90 @@
 #include <QFile>
 #include <algorithm>
 
+namespace
+{
+
+    //* maximum number of suffixes for a given file pattern
+    constexpr int maxSuffixes = 64;
+
+    //* expand alternatives of literal characters and groups, possibly optional, into the list of strings they match
+    /** returns false if the expression contains anything else. Stops at the end of the pattern or at closing parenthesis */
+    bool expand( const QString& pattern, int& position, QStringList& out )
+    {
+        QStringList current( { QString() } );
+        while( position < pattern.size() )
+        {
+
+            const QChar c( pattern.at( position ) );
+            if( c == QLatin1Char( ')' ) ) break;
+            else if( c == QLatin1Char( '|' ) )
+            {
+                out.append( current );
+                current = QStringList( { QString() } );
+                ++position;
+                continue;
+            }
+
+            // parse atom
+            QStringList atom;
+            if( c == QLatin1Char( '(' ) )
+            {
+
+                ++position;
+                if( !expand( pattern, position, atom ) || position >= pattern.size() ) return false;
+                ++position;
+
+            } else if( c == QLatin1Char( '\\' ) ) {
+
+                // only escaped punctuation is literal
+                if( position+1 >= pattern.size() || pattern.at( position+1 ).isLetterOrNumber() ) return false;
+                atom.append( QString( pattern.at( position+1 ) ) );
+                position += 2;
+
+            } else if( c.isLetterOrNumber() || c == QLatin1Char( '_' ) || c == QLatin1Char( '-' ) ) {
+
+                atom.append( QString( c ) );
+                ++position;
+
+            } else return false;
+
+            // optional atom
+            if( position < pattern.size() && pattern.at( position ) == QLatin1Char( '?' ) )
+            {
+                atom.append( QString() );
+                ++position;
+            }
+
+            // concatenate
+            QStringList product;
+            for( const auto& first:current )
+            {
+                for( const auto& second:atom )
+                { product.append( first + second ); }
+            }
+
+            if( product.size() > maxSuffixes ) return false;
+            current = product;
+
+        }
+
+        out.append( current );
+        return out.size() <= maxSuffixes;
+    }
+
+    //* retrieve literal suffixes from a file pattern of the form \.(...)$
+    /** returns false if pattern has any other form */
+    bool suffixes( const QString& pattern, QStringList& out )
+    {
+        if( !( pattern.startsWith( QLatin1String( "\\." ) ) && pattern.endsWith( QLatin1Char( '$' ) ) ) ) return false;
+
+        const QString body( pattern.mid( 2, pattern.size()-3 ) );
+        int position( 0 );
+        return expand( body, position, out ) && position == body.size();
+    }
+
+}
+
 //________________________________________________________
 DocumentClassManager::DocumentClassManager():
     Counter( QStringLiteral("DocumentClassManager") )
@@ -36,8 +120,10 @@ DocumentClassManager::DocumentClassManager():
 void DocumentClassManager::clear()
 {
     Debug::Throw( QStringLiteral("DocumentClassManager::Clear.\n") );
+    QMutexLocker locker( &mutex_ );
     documentClasses_.clear();
     readError_.clear();
+    indexValid_ = false;
 }
 
 //________________________________________________________
@@ -45,29 +131,24 @@ bool DocumentClassManager::read( const File& filename )
 {
     Debug::Throw() << "DocumentClassManager::read - file: " << filename << Qt::endl;
 
+    QMutexLocker locker( &mutex_ );
+
     // reset Read error
     readError_.clear();
 
-    // try open file
-    QFile file( filename );
-    if ( !file.open( QIODevice::ReadOnly ) ) return false;
-
-    // parse file
-    XmlDocument document;
-    if( !document.setContent( &file ) )
-    {
-        readError_ = QString( QObject::tr( "An error occured while parsing document classes.\n %1" ) ).arg( document.error().toString() );
-        return false;
-    }
+    QDomDocument document;
+    if( !_read( filename, document ) ) return false;
+    const auto stamp( DocumentClassCache::stamp( filename ) );
 
-    const auto top = document.get().documentElement();
+    const auto top = document.documentElement();
     for( auto&& node = top.firstChild(); !node.isNull(); node = node.nextSibling() )
     {
         const auto element = node.toElement();
         if( element.isNull() ) continue;
         if( element.tagName() == Xml::DocumentClass )
         {
-            DocumentClass documentClass( element );
+            // only parse header. The rest is parsed on first use
+            DocumentClass documentClass( element, DocumentClass::Mode::Header );
 
             // look for document classes with same name
             const auto iter = std::find_if(
@@ -78,12 +159,10 @@ bool DocumentClassManager::read( const File& filename )
 
             // add new document class
             documentClass.setFile( filename );
+            documentClass.setFileStamp( stamp );
             documentClass.setIsBuildIn( filename.startsWith( ':' ) );
             documentClasses_.append( documentClass );
 
-            // reset IndentPattern counter (for debugging)
-            IndentPattern::resetCounter();
-
         }
     }
 
@@ -92,19 +171,94 @@ bool DocumentClassManager::read( const File& filename )
 
     // sort classes (based on Name())
     std::sort( documentClasses_.begin(), documentClasses_.end(), DocumentClass::WeakLessThanFTor() );
+    indexValid_ = false;
 
     return true;
 
 }
 
 //________________________________________________________
-bool DocumentClassManager::write( const QString& className, const File& filename ) const
+bool DocumentClassManager::reload( const File& filename, QStringList& modified )
+{
+    Debug::Throw() << "DocumentClassManager::reload - file: " << filename << Qt::endl;
+
+    QMutexLocker locker( &mutex_ );
+
+    // reset Read error
+    readError_.clear();
+
+    QDomDocument document;
+    if( !_read( filename, document ) ) return false;
+    const auto stamp( DocumentClassCache::stamp( filename ) );
+
+    // classes currently read from this file
+    QStringList names;
+    for( const auto& documentClass:documentClasses_ )
+    { if( documentClass.file() == filename ) names.append( documentClass.name() ); }
+
+    // new classes
+    List documentClasses;
+    const auto top = document.documentElement();
+    for( auto&& node = top.firstChild(); !node.isNull(); node = node.nextSibling() )
+    {
+        const auto element = node.toElement();
+        if( element.isNull() || element.tagName() != Xml::DocumentClass ) continue;
+
+        const auto iter = std::find_if(
+            documentClasses_.begin(),
+            documentClasses_.end(),
+            DocumentClass::SameNameFTor( element.attribute( Xml::Name ) ) );
+
+        // classes overridden by another file are ignored
+        if( iter != documentClasses_.end() && iter->file() != filename ) continue;
+
+        // classes added to the file
+        if( iter == documentClasses_.end() ) return false;
+
+        // loaded classes are parsed entirely, so that they can be compared
+        DocumentClass documentClass( element, iter->isLoaded() ? DocumentClass::Mode::All:DocumentClass::Mode::Header );
+        documentClass.setFile( filename );
+        documentClass.setFileStamp( stamp );
+        documentClass.setIsBuildIn( iter->isBuildIn() );
+        documentClasses.append( documentClass );
+
+        // reset IndentPattern counter (for debugging)
+        IndentPattern::resetCounter();
+
+    }
+
+    // classes removed from the file
+    if( documentClasses.size() != names.size() ) return false;
+
+    // replace modified classes
+    for( const auto& documentClass:documentClasses )
+    {
+        auto iter = std::find_if(
+            documentClasses_.begin(),
+            documentClasses_.end(),
+            DocumentClass::SameNameFTor( documentClass.name() ) );
+        if( *iter == documentClass ) continue;
+
+        if( iter->isLoaded() ) modified.append( documentClass.name() );
+        *iter = documentClass;
+    }
+
+    // sort classes (based on Name())
+    std::sort( documentClasses_.begin(), documentClasses_.end(), DocumentClass::WeakLessThanFTor() );
+    indexValid_ = false;
+
+    return true;
+
+}
+
+//________________________________________________________
+bool DocumentClassManager::write( const QString& className, const File& filename )
 {
     Debug::Throw() << "DocumentClassManager::write - class: " << className << " file: " << filename << Qt::endl;
 
     // try retrieve DocumentClass
-    const auto iter = std::find_if( documentClasses_.begin(), documentClasses_.end(), DocumentClass::SameNameFTor( className ) );
-    return ( iter == documentClasses_.end() ) ? false : write( *iter,  filename );
+    const auto documentClass( get( className ) );
+    return documentClass.name().isEmpty() ? false : write( documentClass,  filename );
 
 }
 
@@ -131,7 +285,7 @@ bool DocumentClassManager::write( const DocumentClass& documentClass, const File
 }
 
 //________________________________________________________
-bool DocumentClassManager::write( const File& path ) const
+bool DocumentClassManager::write( const File& path )
 {
     Debug::Throw() << "DocumentClassManager::write - path: " << path << Qt::endl;
 
@@ -147,8 +301,10 @@ bool DocumentClassManager::write( const File& path ) const
         return false;
     }
 
-    for( const auto& documentClass:documentClasses_ )
+    QMutexLocker locker( &mutex_ );
+    for( auto& documentClass:documentClasses_ )
     {
+        _load( documentClass );
         File filename( documentClass.file().localName().addPath( path ) );
         Debug::Throw(0) << "DocumentClassManager::write - writing class " << documentClass.name() << " to file " << filename << Qt::endl;
 
@@ -173,41 +329,80 @@ bool DocumentClassManager::write( const File& path ) const
 }
 
 //________________________________________________________
-DocumentClass DocumentClassManager::defaultClass() const
+DocumentClass DocumentClassManager::defaultClass()
 {
 
     Debug::Throw( QStringLiteral("DocumentClassManager::defaultClass.\n") );
 
+    QMutexLocker locker( &mutex_ );
     const auto iter = std::find_if( documentClasses_.begin(), documentClasses_.end(), DocumentClass::IsDefaultFTor() );
-    return (iter == documentClasses_.end()) ? DocumentClass():*iter;
+    return (iter == documentClasses_.end()) ? DocumentClass():_load( *iter );
 
 }
 
 //________________________________________________________
-DocumentClass DocumentClassManager::find( const File& filename ) const
+DocumentClass DocumentClassManager::find( const File& filename )
 {
     Debug::Throw() << "DocumentClassManager::find - file: " << filename << Qt::endl;
 
-    // try load class matching name
-    const auto iter = std::find_if(
-        documentClasses_.begin(),
-        documentClasses_.end(),
-        DocumentClass::MatchFileFTor( filename ) );
-    return iter == documentClasses_.end() ? defaultClass():*iter;
+    QMutexLocker locker( &mutex_ );
+    if( !indexValid_ ) _buildIndex();
+
+    // classes matching file suffixes
+    QVector<int> suffixMatches;
+    for( int position = filename.indexOf( QLatin1Char( '.' ) ); position >= 0; position = filename.indexOf( QLatin1Char( '.' ), position+1 ) )
+    {
+        const auto iter( suffixes_.constFind( filename.mid( position+1 ) ) );
+        if( iter != suffixes_.constEnd() ) suffixMatches.append( iter.value() );
+    }
+
+    // first line is read at most once, and only if needed
+    bool firstLineRead( false );
+    QString firstLine;
+
+    // find first non default class matching either file name or first line
+    for( int index = 0; index < documentClasses_.size(); ++index )
+    {
+        auto& documentClass( documentClasses_[index] );
+        if( documentClass.isDefault() ) continue;
+
+        if( indexed_.at( index ) ? suffixMatches.contains( index ) : documentClass.matchFileName( filename ) )
+        { return _load( documentClass ); }
+
+        if( !documentClass.hasFirstLinePattern() ) continue;
+        if( !firstLineRead )
+        {
+            firstLineRead = true;
+            firstLine = DocumentClass::firstLine( filename );
+
+            // discard line if it matches none of the first line patterns
+            if( !firstLinePattern_.match( firstLine ).hasMatch() ) firstLine.clear();
+        }
+
+        if( documentClass.matchFirstLine( firstLine ) )
+        { return _load( documentClass ); }
+
+    }
+
+    // fallback to default class
+    const auto iter = std::find_if( documentClasses_.begin(), documentClasses_.end(), DocumentClass::IsDefaultFTor() );
+    return iter == documentClasses_.end() ? DocumentClass():_load( *iter );
 
 }
 
 //________________________________________________________
-DocumentClass DocumentClassManager::get( const QString& name ) const
+DocumentClass DocumentClassManager::get( const QString& name )
 {
     Debug::Throw() << "DocumentClassManager::Get - name: " << name << Qt::endl;
 
+    QMutexLocker locker( &mutex_ );
+
     // try load class matching name
     const auto iter = std::find_if(
         documentClasses_.begin(),
         documentClasses_.end(),
         DocumentClass::SameNameFTor( name ) );
-    return  iter == documentClasses_.end() ? DocumentClass():*iter;
+    return  iter == documentClasses_.end() ? DocumentClass():_load( *iter );
 
 }
 
@@ -215,6 +410,7 @@ DocumentClass DocumentClassManager::get( const QString& name ) const
 bool DocumentClassManager::remove( const QString& name )
 {
     Debug::Throw() << "DocumentClassManager::Remove - name: " << name << Qt::endl;
+    QMutexLocker locker( &mutex_ );
 
     // find class list matching name
     const auto iter = std::find_if(
@@ -224,5 +420,116 @@ bool DocumentClassManager::remove( const QString& name )
     if( iter == documentClasses_.end() ) return false;
 
     documentClasses_.erase( iter );
+    indexValid_ = false;
+    return true;
+}
+
+//________________________________________________________
+bool DocumentClassManager::_read( const File& filename, QDomDocument& document )
+{
+    Debug::Throw() << "DocumentClassManager::_read - file: " << filename << Qt::endl;
+
+    // try open file
+    QFile file( filename );
+    if ( !file.open( QIODevice::ReadOnly ) ) return false;
+
+    // use cached document if file is unchanged, parse file otherwise
+    if( cache_.find( filename, document ) ) return true;
+
+    XmlDocument xmlDocument;
+    if( !xmlDocument.setContent( &file ) )
+    {
+        readError_ = QString( QObject::tr( "An error occured while parsing document classes.\n %1" ) ).arg( xmlDocument.error().toString() );
+        return false;
+    }
+
+    document = xmlDocument.get();
+    cache_.insert( filename, document );
     return true;
+
+}
+
+//________________________________________________________
+const DocumentClass& DocumentClassManager::_load( DocumentClass& documentClass )
+{
+
+    if( documentClass.isLoaded() ) return documentClass;
+    Debug::Throw() << "DocumentClassManager::_load - class: " << documentClass.name() << Qt::endl;
+
+    // parse file again, and look for matching element
+    QDomDocument document;
+    if( !_read( documentClass.file(), document ) )
+    {
+        Debug::Throw(0) << "DocumentClassManager::_load - cannot read " << documentClass.file() << Qt::endl;
+        return documentClass;
+    }
+
+    const auto top = document.documentElement();
+    for( auto&& node = top.firstChild(); !node.isNull(); node = node.nextSibling() )
+    {
+        const auto element = node.toElement();
+        if( element.isNull() ) continue;
+        if( element.tagName() == Xml::DocumentClass && element.attribute( Xml::Name ) == documentClass.name() )
+        {
+            DocumentClass loaded( element );
+            loaded.setFile( documentClass.file() );
+            loaded.setFileStamp( documentClass.fileStamp() );
+            loaded.setIsBuildIn( documentClass.isBuildIn() );
+            documentClass = loaded;
+
+            // reset IndentPattern counter (for debugging)
+            IndentPattern::resetCounter();
+
+            return documentClass;
+        }
+    }
+
+    Debug::Throw(0) << "DocumentClassManager::_load - class " << documentClass.name() << " not found in " << documentClass.file() << Qt::endl;
+    return documentClass;
+
+}
+
+//________________________________________________________
+void DocumentClassManager::_buildIndex()
+{
+    Debug::Throw( QStringLiteral("DocumentClassManager::_buildIndex.\n") );
+
+    suffixes_.clear();
+    indexed_.fill( false, documentClasses_.size() );
+
+    // combining first line patterns breaks back references, and recursions
+    static const QRegularExpression referenceRegexp( QStringLiteral( "\\\\[1-9gk]|\\(\\?(P[=>]|[&R]|[+-]?[0-9])" ) );
+    QStringList firstLinePatterns;
+    bool combine( true );
+
+    for( int index = 0; index < documentClasses_.size(); ++index )
+    {
+        const auto& documentClass( documentClasses_.at( index ) );
+
+        // file pattern
+        QStringList literals;
+        if( documentClass.fileMatchingPattern().isValid() && suffixes( documentClass.fileMatchingPattern().pattern(), literals ) )
+        {
+            indexed_[index] = true;
+            for( const auto& literal:literals )
+            { suffixes_[literal].append( index ); }
+        }
+
+        // first line pattern
+        if( documentClass.hasFirstLinePattern() )
+        {
+            const auto& pattern( documentClass.firstLineMatchingPattern().pattern() );
+            if( pattern.contains( referenceRegexp ) ) combine = false;
+            firstLinePatterns.append( QStringLiteral( "(?:%1)" ).arg( pattern ) );
+        }
+
+    }
+
+    // an empty pattern matches all lines
+    firstLinePattern_.setPattern( combine ? firstLinePatterns.join( QLatin1Char( '|' ) ):QString() );
+    if( !firstLinePattern_.isValid() ) firstLinePattern_.setPattern( QString() );
+    firstLinePattern_.optimize();
+
+    indexValid_ = true;
+
 }
@@ -22,9 +22,15 @@
 
 #include "Counter.h"
 #include "Debug.h"
+#include "DocumentClassCache.h"
 #include "File.h"
 
+#include <QDomDocument>
+#include <QHash>
+#include <QMutexLocker>
+#include <QRegularExpression>
 #include <QString>
+#include <QStringList>
 #include <QVector>
 
 class DocumentClass;
@@ -46,29 +52,62 @@ class DocumentClassManager final: private Base::Counter<DocumentClassManager>
     void clear();
 
     //* read classes from file
+    /**
+    parsed files are retrieved from the cache, if set and up to date.
+    Only class headers are parsed. The rest is parsed the first time the class is returned by get or find
+    */
     bool read( const File& file );
 
+    //* reload classes from a modified file
+    /**
+    classes whose content changed are replaced, and their names appended to the list.
+    Returns false if the file cannot be read, or if classes have been added to or removed from it,
+    in which case all classes must be read again
+    */
+    bool reload( const File& file, QStringList& modified );
+
+    //* cache file
+    void setCacheFile( const File& file )
+    {
+        QMutexLocker locker( &mutex_ );
+        cache_.setFile( file );
+    }
+
+    //* write cache
+    /**
+    when prune is true, only files read since the last pruning write are kept.
+    Writes that follow reading a subset of the files, such as reloading modified ones, must not prune the cache
+    */
+    bool writeCache( bool prune = true )
+    {
+        QMutexLocker locker( &mutex_ );
+        return cache_.write( prune );
+    }
+
     //* read errors
-    const QString& readError() const
-    { return readError_; }
+    QString readError() const
+    {
+        QMutexLocker locker( &mutex_ );
+        return readError_;
+    }
 
     //* write all classes to file
-    bool write( const File& path ) const;
+    bool write( const File& path );
 
     //* write classe to file
-    bool write( const QString&, const File& ) const;
+    bool write( const QString&, const File& );
 
     //* write classe to file
     bool write( const DocumentClass&, const File& ) const;
 
     //* get default document class
-    DocumentClass defaultClass() const;
+    DocumentClass defaultClass();
 
     //* get class matching filename. Return 0 if not found
-    DocumentClass find( const File& file ) const;
+    DocumentClass find( const File& file );
 
     //* get class matching name. Return 0 if none found
-    DocumentClass get( const QString& name ) const;
+    DocumentClass get( const QString& name );
 
     //* remove a class matching name.
     bool remove( const QString& name );
@@ -77,20 +116,65 @@ class DocumentClassManager final: private Base::Counter<DocumentClassManager>
     using List = QVector<DocumentClass>;
 
     //* get all classes
-    const List& classes() const
-    { return documentClasses_; }
+    /**
+    classes that have not been returned by get or find only contain their header.
+    A copy is returned, since classes are modified when loaded from other threads
+    */
+    List classes() const
+    {
+        QMutexLocker locker( &mutex_ );
+        return documentClasses_;
+    }
 
     //* set all classes
     void setClasses( const List& classes )
-    { documentClasses_ = classes; }
+    {
+        QMutexLocker locker( &mutex_ );
+        documentClasses_ = classes;
+        indexValid_ = false;
+    }
 
     private:
 
+    //* parse file, or retrieve it from cache
+    bool _read( const File&, QDomDocument& );
+
+    //* parse all content of a class, if not done already, and return it
+    const DocumentClass& _load( DocumentClass& );
+
+    //* build file matching index
+    void _buildIndex();
+
     //* list of document classes
     List documentClasses_;
 
     //* read error
     QString readError_;
+
+    //* parsed files
+    DocumentClassCache cache_;
+
+    //*@name file matching index
+    //@{
+
+    //* true when index matches current classes
+    bool indexValid_ = false;
+
+    //* literal file suffixes, and classes which file pattern matches them
+    QHash<QString, QVector<int>> suffixes_;
+
+    //* true for classes which file pattern is stored in suffixes
+    QVector<bool> indexed_;
+
+    //* all first line patterns, combined
+    /** it is used to check whether any first line pattern matches before testing them one by one */
+    QRegularExpression firstLinePattern_;
+
+    //@}
+
+    //* protect classes and cache when loaded from different threads
+    mutable QMutex mutex_;
+
 };
 
 #endif
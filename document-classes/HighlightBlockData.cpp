@@ -28,6 +28,19 @@ HighlightBlockData::HighlightBlockData():
     parenthesisLength_(0)
 {}
 
+//____________________________________________________________
+bool HighlightBlockData::isEmpty() const
+{
+    if( !( locations_.empty() && delimiters_.get().empty() && !hasParenthesis() ) ) return false;
+    if( hasFlag( TextBlock::BlockModified | TextBlock::BlockCollapsed | TextBlock::SpellCheckPending | TextBlock::All ) ) return false;
+
+    #if WITH_ASPELL
+    if( !words_.empty() ) return false;
+    #endif
+
+    return true;
+}
+
 #if WITH_ASPELL
 
 //____________________________________________________________
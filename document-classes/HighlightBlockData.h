@@ -49,16 +49,32 @@ class HighlightBlockData: public TextBlockData
     {}
 
     //* syntax highlighting pattern locations
-    const PatternLocationSet& locations() const
+    PatternLocationSet locations() const
+    { return PatternLocationSet( locations_ ); }
+
+    //* syntax highlighting pattern locations, as stored
+    const PatternLocationSet::Compact& compactLocations() const
     { return locations_; }
 
+    //* active ids of syntax highlighting pattern locations
+    const std::pair<int,int>& activeId() const
+    { return locations_.activeId(); }
+
     //* syntax highlighting pattern locations
     void setLocations( const PatternLocationSet& locations )
+    { locations_ = PatternLocationSet::Compact( locations ); }
+
+    //* syntax highlighting pattern locations
+    void setLocations( const PatternLocationSet::Compact& locations )
     { locations_ = locations; }
 
     //* return true if locations correspond to a commented block
     bool ignoreBlock() const
-    { return (!locations().empty()) && locations().begin()->hasFlag( HighlightPattern::NoIndent ); }
+    { return (!locations_.empty()) && locations_.begin()->hasFlag( HighlightPattern::NoIndent ); }
+
+    //* true if there is nothing to store for the block
+    /** such blocks need no data at all */
+    bool isEmpty() const;
 
     //*@name parenthesis
     //@{
@@ -122,7 +138,7 @@ class HighlightBlockData: public TextBlockData
     private:
 
     //* locations and ids of matching syntax highlighting patterns
-    PatternLocationSet locations_;
+    PatternLocationSet::Compact locations_;
 
     //* highlighted parenthesis location
     /** local with respect to the block */
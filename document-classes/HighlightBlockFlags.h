@@ -35,6 +35,7 @@ namespace TextBlock
         DiffAdded = 1<<4,
         DiffConflict = 1<<5,
         User = 1<<6,
+        SpellCheckPending = 1<<7,
         All = DiffAdded | DiffConflict | User
 
     };
@@ -0,0 +1,163 @@
+/******************************************************************************
+*
+* Copyright (C) 2002 Hugo PEREIRA <mailto: hugo.pereira@free.fr>
+*
+* This is free software; you can redistribute it and/or modify it under the
+* terms of the GNU General Public License as published by the Free Software
+* Foundation; either version 2 of the License, or (at your option) any later
+* version.
+*
+* This software is distributed in the hope that it will be useful, but WITHOUT
+* Any WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along with
+* this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*******************************************************************************/
+
+#include "HighlightCache.h"
+#include "Debug.h"
+#include "DocumentClass.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+
+namespace
+{
+    //* configuration
+    class Data final
+    {
+        public:
+
+        //* path
+        QString path_;
+
+        //* maximum size
+        qint64 maxSize_ = 0;
+    };
+
+    //* process-wide instance
+    Data& data()
+    {
+        static Data data;
+        return data;
+    }
+
+    //* magic number, written at the beginning of each entry
+    const quint32 magic = 0x71656863;
+
+    //* format version, to be incremented whenever locations change
+    const quint32 version = 1;
+}
+
+//___________________________________________________________________________
+void HighlightCache::setPath( const QString& path )
+{ data().path_ = path; }
+
+//___________________________________________________________________________
+void HighlightCache::setMaxSize( qint64 value )
+{ data().maxSize_ = value; }
+
+//___________________________________________________________________________
+QByteArray HighlightCache::key( const QByteArray& content, const QByteArray& encoding, const DocumentClass& documentClass )
+{
+
+    if( content.size() < minSize || documentClass.name().isEmpty() || documentClass.fileStamp().isEmpty() ) return QByteArray();
+
+    QCryptographicHash hash( QCryptographicHash::Sha1 );
+    hash.addData( QByteArray::number( version ) );
+
+    // document class
+    hash.addData( documentClass.name().toUtf8() );
+    hash.addData( documentClass.fileStamp() );
+
+    // content
+    hash.addData( encoding );
+    hash.addData( content );
+    return hash.result();
+
+}
+
+//___________________________________________________________________________
+bool HighlightCache::find( const QByteArray& key, Locations& locations )
+{
+
+    if( key.isEmpty() || data().path_.isEmpty() || data().maxSize_ <= 0 ) return false;
+
+    QFile in( _fileName( key ) );
+    if( !in.open( QIODevice::ReadOnly ) ) return false;
+
+    QDataStream stream( &in );
+    quint32 fileMagic = 0;
+    quint32 fileVersion = 0;
+    stream >> fileMagic >> fileVersion;
+    if( fileMagic != magic || fileVersion != version ) return false;
+
+    Locations out;
+    stream >> out;
+    if( stream.status() != QDataStream::Ok ) return false;
+
+    Debug::Throw() << "HighlightCache::find - found: " << in.fileName() << " blocks: " << out.size() << Qt::endl;
+
+    // mark entry as recently used
+    in.setFileTime( QDateTime::currentDateTime(), QFileDevice::FileModificationTime );
+
+    locations.swap( out );
+    return true;
+
+}
+
+//___________________________________________________________________________
+void HighlightCache::insert( const QByteArray& key, const Locations& locations )
+{
+
+    if( key.isEmpty() || data().path_.isEmpty() || data().maxSize_ <= 0 ) return;
+
+    // make sure path exists
+    QDir path( data().path_ );
+    if( !( path.exists() || path.mkpath( QStringLiteral(".") ) ) ) return;
+
+    QFile out( _fileName( key ) );
+    if( !out.open( QIODevice::WriteOnly ) ) return;
+
+    QDataStream stream( &out );
+    stream << magic << version << locations;
+    out.close();
+
+    // remove incomplete entries
+    if( stream.status() != QDataStream::Ok )
+    {
+        out.remove();
+        return;
+    }
+
+    Debug::Throw() << "HighlightCache::insert - stored: " << out.fileName() << " blocks: " << locations.size() << Qt::endl;
+    _evict();
+
+}
+
+//___________________________________________________________________________
+QString HighlightCache::_fileName( const QByteArray& key )
+{ return QDir( data().path_ ).filePath( QString::fromLatin1( key.toHex() ) ); }
+
+//___________________________________________________________________________
+void HighlightCache::_evict()
+{
+
+    // most recently used first
+    const auto entries( QDir( data().path_ ).entryInfoList( QDir::Files, QDir::Time ) );
+
+    qint64 size = 0;
+    for( const auto& entry:entries )
+    {
+        size += entry.size();
+        if( size > data().maxSize_ ) QFile::remove( entry.absoluteFilePath() );
+    }
+
+}
@@ -0,0 +1,79 @@
+#ifndef HighlightCache_h
+#define HighlightCache_h
+
+/******************************************************************************
+*
+* Copyright (C) 2002 Hugo PEREIRA <mailto: hugo.pereira@free.fr>
+*
+* This is free software; you can redistribute it and/or modify it under the
+* terms of the GNU General Public License as published by the Free Software
+* Foundation; either version 2 of the License, or (at your option) any later
+* version.
+*
+* This software is distributed in the hope that it will be useful, but WITHOUT
+* Any WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along with
+* this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*******************************************************************************/
+#include "PatternLocationSet.h"
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+
+class DocumentClass;
+
+//* highlight locations of previously opened documents, stored on disk
+/**
+entries are keyed by a hash of the document content and encoding, together with the stamp of the file
+defining the document class, so that they become invalid whenever either changes.
+Each entry is stored in its own file. The least recently used ones are removed first
+when the total size exceeds the maximum size
+*/
+class HighlightCache final
+{
+
+    public:
+
+    //* locations and active ids, one per block
+    using Locations = QVector<PatternLocationSet::Compact>;
+
+    //* minimum document size (in bytes) for which locations are cached
+    static const int minSize = 1<<20;
+
+    //*@name configuration
+    //@{
+
+    //* directory in which entries are stored
+    static void setPath( const QString& );
+
+    //* maximum total size of the entries (bytes)
+    static void setMaxSize( qint64 );
+
+    //@}
+
+    //* key for a given document content, as read from file, encoding and class. Empty if content is too small
+    /** raw content is hashed rather than decoded text, which is twice larger */
+    static QByteArray key( const QByteArray& content, const QByteArray& encoding, const DocumentClass& );
+
+    //* retrieve locations matching key. Returns false if not found
+    static bool find( const QByteArray& key, Locations& );
+
+    //* store locations
+    static void insert( const QByteArray& key, const Locations& );
+
+    private:
+
+    //* file matching a given key
+    static QString _fileName( const QByteArray& key );
+
+    //* remove least recently used entries until total size fits
+    static void _evict();
+
+};
+
+#endif
@@ -22,20 +22,28 @@
 #include "XmlDef.h"
 #include "XmlString.h"
 
+#include <QElapsedTimer>
+#include <QVector>
+
 
 //___________________________________________________________________________
 QString HighlightPattern::noParentPattern_( QStringLiteral("None") );
 
+//___________________________________________________________________________
+QAtomicInt HighlightPattern::overBudgetSerial_;
+
 //___________________________________________________________________________
 HighlightPattern::HighlightPattern():
     Counter( QStringLiteral("HighlightPattern") ),
-    name_( QStringLiteral("default") )
+    name_( QStringLiteral("default") ),
+    statistics_( std::make_shared<Statistics>() )
 {}
 
 //___________________________________________________________________________
 HighlightPattern::HighlightPattern( const QDomElement& element ):
     Counter( QStringLiteral("HighlightPattern") ),
-    name_( QStringLiteral("default") )
+    name_( QStringLiteral("default") ),
+    statistics_( std::make_shared<Statistics>() )
 {
     Debug::Throw( QStringLiteral("HighlightPattern::HighlightPattern.\n") );
     if( element.tagName() == Xml::KeywordPattern ) setType( Type::KeywordPattern );
@@ -152,6 +160,158 @@ bool HighlightPattern::isValid() const
     }
 }
 
+//____________________________________________________________
+bool HighlightPattern::isBacktrackingProne() const
+{
+    switch( type_ )
+    {
+        case Type::KeywordPattern:
+        return _hasNestedQuantifiers( keyword_.pattern() );
+
+        case Type::RangePattern:
+        return _hasNestedQuantifiers( keyword_.pattern() ) || _hasNestedQuantifiers( end_.pattern() );
+
+        default: return false;
+    }
+}
+
+//____________________________________________________________
+bool HighlightPattern::_profileText( PatternLocationSet& locations, const QString& text, int from, int to, bool& active ) const
+{
+    const int size( locations.size() );
+    QElapsedTimer timer;
+    timer.start();
+
+    const bool found( _processText( locations, text, from, to, active ) );
+    locations.merge( size );
+    statistics_->profile_.add( timer.nsecsElapsed(), locations.size() - size );
+    return found;
+}
+
+//____________________________________________________________
+bool HighlightPattern::_discard( PatternLocationSet& locations, bool& active ) const
+{
+    // child pattern locations in the discarded ranges are removed too
+    locations.removeAll( id_ );
+    active = false;
+
+    statistics_->overBudgetCount_.ref();
+    overBudgetSerial_.ref();
+    return false;
+}
+
+//____________________________________________________________
+bool HighlightPattern::_hasNestedQuantifiers( const QString& pattern )
+{
+
+    // for each open group, true if it contains an unbounded quantifier
+    // atomic groups are never backtracked into, and are considered bounded
+    QVector<bool> repeated( 1, false );
+    QVector<bool> atomic( 1, false );
+    for( int i = 0; i < pattern.size(); )
+    {
+
+        const auto character( pattern.at(i) );
+        bool group( false );
+        bool groupRepeated( false );
+        if( character == QLatin1Char( '\\' ) )
+        {
+
+            i += 2;
+
+        } else if( character == QLatin1Char( '[' ) ) {
+
+            // first closing bracket, possibly after negation, is a literal
+            ++i;
+            if( i < pattern.size() && pattern.at(i) == QLatin1Char( '^' ) ) ++i;
+            if( i < pattern.size() && pattern.at(i) == QLatin1Char( ']' ) ) ++i;
+            while( i < pattern.size() && pattern.at(i) != QLatin1Char( ']' ) )
+            { i += ( pattern.at(i) == QLatin1Char( '\\' ) ) ? 2:1; }
+            ++i;
+
+        } else if( character == QLatin1Char( '(' ) ) {
+
+            repeated.append( false );
+            atomic.append( i+2 < pattern.size() && pattern.at(i+1) == QLatin1Char( '?' ) && pattern.at(i+2) == QLatin1Char( '>' ) );
+            ++i;
+            continue;
+
+        } else if( character == QLatin1Char( ')' ) ) {
+
+            // unbalanced parenthesis. The pattern is invalid anyway
+            if( repeated.size() < 2 ) return false;
+            group = true;
+            groupRepeated = repeated.takeLast() && !atomic.takeLast();
+            ++i;
+
+        } else ++i;
+
+        // quantifier
+        bool quantified( false );
+        bool unbounded( false );
+        if( i < pattern.size() )
+        {
+
+            const auto next( pattern.at(i) );
+            if( next == QLatin1Char( '*' ) || next == QLatin1Char( '+' ) )
+            {
+
+                quantified = true;
+                unbounded = true;
+                ++i;
+
+            } else if( next == QLatin1Char( '?' ) ) {
+
+                quantified = true;
+                ++i;
+
+            } else if( next == QLatin1Char( '{' ) ) {
+
+                // braces are literal unless they form a valid {n}, {n,} or {n,m} quantifier
+                int j( i+1 );
+                while( j < pattern.size() && pattern.at(j).isDigit() ) ++j;
+                if( j > i+1 && j < pattern.size() )
+                {
+                    bool open( false );
+                    if( pattern.at(j) == QLatin1Char( ',' ) )
+                    {
+                        const int first( ++j );
+                        while( j < pattern.size() && pattern.at(j).isDigit() ) ++j;
+                        open = ( j == first );
+                    }
+
+                    if( j < pattern.size() && pattern.at(j) == QLatin1Char( '}' ) )
+                    {
+                        quantified = true;
+                        unbounded = open;
+                        i = j+1;
+                    }
+                }
+
+            }
+
+        }
+
+        // lazy and possessive quantifiers. The latter do not backtrack
+        if( quantified && i < pattern.size() )
+        {
+            if( pattern.at(i) == QLatin1Char( '+' ) )
+            {
+                unbounded = false;
+                ++i;
+            } else if( pattern.at(i) == QLatin1Char( '?' ) ) ++i;
+        }
+
+        // an unbounded quantifier applied to a group that already contains one
+        if( group && unbounded && groupRepeated ) return true;
+        if( unbounded || groupRepeated ) repeated.last() = true;
+
+    }
+
+    return false;
+
+}
+
 //____________________________________________________________
 void HighlightPattern::_updatePatternOptions( QRegularExpression& regexp ) const
 {
@@ -161,7 +321,65 @@ void HighlightPattern::_updatePatternOptions( QRegularExpression& regexp ) const
 }
 
 //____________________________________________________________
-bool HighlightPattern::_findKeyword( PatternLocationSet& locations, const QString& text, bool& active ) const
+void HighlightPattern::_updateFilters()
+{
+    keywordFilter_ = RegularExpressionFilter( keyword_ );
+    endFilter_ = RegularExpressionFilter( end_ );
+    wordList_ = WordListMatcher( keyword_ );
+
+    matchKeyword_ = _bounded( keyword_ );
+    matchEnd_ = _bounded( end_ );
+    bounded_ = matchKeyword_.pattern() != keyword_.pattern() || matchEnd_.pattern() != end_.pattern();
+}
+
+//____________________________________________________________
+QRegularExpression HighlightPattern::_bounded( const QRegularExpression& regexp )
+{
+    if( !_hasNestedQuantifiers( regexp.pattern() ) ) return regexp;
+
+    // a match that exceeds the limit fails, and the resulting match object is invalid
+    return QRegularExpression(
+        QStringLiteral( "(*LIMIT_MATCH=%1)" ).arg( maxMatchSteps ) + regexp.pattern(),
+        regexp.patternOptions() );
+}
+
+//____________________________________________________________
+int HighlightPattern::_filter( const RegularExpressionFilter& filter, const QString& text, int from, int to ) const
+{
+    if( !filter.isValid() ) return from;
+
+    const int position( filter.indexIn( text, from, to ) );
+    _countFilter( position );
+    return position;
+}
+
+//____________________________________________________________
+int HighlightPattern::_findDelimiter( const QRegularExpression& regexp, const RegularExpressionFilter& filter, const QString& text, int from, int to, int& length ) const
+{
+
+    // literal delimiters need no regular expression
+    if( filter.isExact() )
+    {
+        const int position( QStringView( text ).left( to ).indexOf( filter.literal(), from, filter.caseSensitivity() ) );
+        _countFilter( position );
+        if( position >= 0 ) length = filter.literal().size();
+        return position;
+    }
+
+    from = _filter( filter, text, from, to );
+    if( from < 0 ) return -1;
+
+    const auto match( HighlightPattern::match( regexp, text, from, to ) );
+    if( !match.isValid() ) return matchFailed;
+    if( !match.hasMatch() ) return -1;
+
+    length = match.capturedLength();
+    return match.capturedStart();
+
+}
+
+//____________________________________________________________
+bool HighlightPattern::_findKeyword( PatternLocationSet& locations, const QString& text, int from, int to, bool& active ) const
 {
     // disable activity
     active=false;
@@ -169,28 +387,84 @@ bool HighlightPattern::_findKeyword( PatternLocationSet& locations, const QStrin
     // check RegExp
     if( keyword_.pattern().isEmpty() ) return false;
     
-    // process text
+    // word lists
     bool found( false );
-    auto iter = keyword_.globalMatch( text );
-    while( iter.hasNext() )
+    if( wordList_.isValid() && wordList_.accepts( text, from, to ) )
+    {
+        int length( 0 );
+        for( int position = wordList_.indexIn( text, from, to, length ); position >= 0; position = wordList_.indexIn( text, position+length, to, length ) )
+        {
+            locations.append( PatternLocation( *this, position, length ) );
+            found = true;
+        }
+
+        return found;
+    }
+
+    // skip text that cannot match
+    const int offset( _filter( keywordFilter_, text, from, to ) );
+    if( offset < 0 ) return false;
+
+    // process text
+    if( !bounded_ )
     {
-        const auto match( iter.next() );
-        locations.insert( PatternLocation( *this, match.capturedStart(), match.capturedLength() ) );
+        auto iter = globalMatch( keyword_, text, offset, to );
+        while( iter.hasNext() )
+        {
+            const auto match( iter.next() );
+            locations.append( PatternLocation( *this, match.capturedStart(), match.capturedLength() ) );
+            found = true;
+        }
+
+        return found;
+    }
+
+    // bounded patterns are matched one at a time, so that failed matches are seen
+    int matches( 0 );
+    auto match( HighlightPattern::match( matchKeyword_, text, offset, to ) );
+    while( match.hasMatch() )
+    {
+        if( ++matches > maxBlockMatches ) return _discard( locations, active );
+
+        locations.append( PatternLocation( *this, match.capturedStart(), match.capturedLength() ) );
         found = true;
+
+        // empty matches move on to the next character
+        int next( match.capturedEnd() );
+        if( !match.capturedLength() )
+        {
+            if( next >= to ) break;
+            next += text.at( next ).isHighSurrogate() ? 2:1;
+        }
+
+        match = HighlightPattern::match( matchKeyword_, text, next, to );
     }
 
+    // maximum number of steps was reached
+    if( !match.isValid() ) return _discard( locations, active );
     return found;
 }
 
 //____________________________________________________________
-bool HighlightPattern::_findRange( PatternLocationSet& locations, const QString& text, bool& active ) const
+bool HighlightPattern::_findRange( PatternLocationSet& locations, const QString& text, int from, int to, bool& active ) const
 {
 
     // check RegExp
     if( keyword_.pattern().isEmpty() || end_.pattern().isEmpty() ) return false;
 
-    int begin(0);
-    int end(0);
+    // identical literal delimiters, such as quotes
+    const bool sameDelimiters(
+        keywordFilter_.isExact() && endFilter_.isExact() &&
+        keywordFilter_.caseSensitivity() == endFilter_.caseSensitivity() &&
+        keywordFilter_.literal().compare( endFilter_.literal(), keywordFilter_.caseSensitivity() ) == 0 );
+
+    // number of delimiter pairs found, for bounded patterns
+    int matches( 0 );
+
+    int begin( from );
+    int end( from );
+    int beginLength(0);
+    int endLength(0);
 
     bool found( false );
 
@@ -200,15 +474,15 @@ bool HighlightPattern::_findRange( PatternLocationSet& locations, const QString&
     {
 
         // if active, look for end match
-        QRegularExpressionMatch match;
-        end = text.indexOf( end_, 0, &match);
+        end = _findDelimiter( matchEnd_, endFilter_, text, from, to, endLength );
+        if( end == matchFailed ) return _discard( locations, active );
         if( end < 0 )
         {
 
             // no match found.
             // pattern is still active for next paragraph
             // the whole paragraph match the pattern
-            locations.insert( PatternLocation( *this, 0, text.size() ) );
+            locations.append( PatternLocation( *this, from, to-from ) );
             return true;
 
         } else {
@@ -217,36 +491,48 @@ bool HighlightPattern::_findRange( PatternLocationSet& locations, const QString&
             // pattern is not active any more but one needs to check if it does not start again
             active = false;
             found = true;
-            end += match.capturedLength();
-            locations.insert( PatternLocation( *this, 0, end ) );
+            end += endLength;
+            locations.append( PatternLocation( *this, from, end-from ) );
 
         }
 
     }
 
     // look for begin and end in current paragraphs
+    // each search starts where the previous one stopped, so that text is scanned once
     forever
     {
 
         // look for begin match
-        // start from end index, which is either 0, or the last
+        // start from end index, which is either from, or the last
         // found end in case of spanning active patterns
-        QRegularExpressionMatch beginMatch;
-        begin = end;
-        begin = text.indexOf( keyword_, begin, &beginMatch );
+        begin = _findDelimiter( matchKeyword_, keywordFilter_, text, end, to, beginLength );
+        if( begin == matchFailed ) return _discard( locations, active );
         if( begin < 0 )
         {
             active = false;
             break;
         }
 
-        // look for end match
-        QRegularExpressionMatch endMatch;
-        end = text.indexOf( end_, begin, &endMatch );
+        if( sameDelimiters ) {
+
+            // the end delimiter would first match the begin delimiter itself
+            end = _findDelimiter( matchEnd_, endFilter_, text, begin + beginLength, to, endLength );
 
-        // avoid zero length match
-        if( begin == end && beginMatch.capturedLength() == endMatch.capturedLength() )
-        { end = text.indexOf( end_, begin + beginMatch.capturedLength() ); }
+        } else {
+
+            // look for end match
+            end = _findDelimiter( matchEnd_, endFilter_, text, begin, to, endLength );
+
+            // avoid zero length match
+            // note that the length of the first end match is kept
+            int length(0);
+            if( begin == end && beginLength == endLength )
+            { end = _findDelimiter( matchEnd_, endFilter_, text, begin + beginLength, to, length ); }
+
+        }
+
+        if( end == matchFailed ) return _discard( locations, active );
 
         if( end < 0 )
         {
@@ -256,7 +542,7 @@ bool HighlightPattern::_findRange( PatternLocationSet& locations, const QString&
                 // Pattern will still be active in next paragraph
                 found = true;
                 active = true;
-                locations.insert( PatternLocation( *this, begin, text.size()-begin ) );
+                locations.append( PatternLocation( *this, begin, to-begin ) );
             }
 
             break;
@@ -265,8 +551,10 @@ bool HighlightPattern::_findRange( PatternLocationSet& locations, const QString&
         // found end matching begin
         // append new text location
         found = true;
-        end += endMatch.capturedLength();
-        locations.insert( PatternLocation( *this, begin, end-begin ) );
+        end += endLength;
+        locations.append( PatternLocation( *this, begin, end-begin ) );
+
+        if( bounded_ && ++matches > maxBlockMatches ) return _discard( locations, active );
 
     }
 
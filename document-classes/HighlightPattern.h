@@ -23,13 +23,20 @@
 #include "Counter.h"
 #include "Debug.h"
 #include "Functors.h"
+#include "HighlightProfiler.h"
 #include "HighlightStyle.h"
+#include "RegularExpressionFilter.h"
+#include "WordListMatcher.h"
 
+#include <QAtomicInt>
 #include <QDomElement>
 #include <QDomDocument>
 #include <QRegularExpression>
 #include <QString>
 #include <QList>
+#include <QVector>
+
+#include <memory>
 
 class PatternLocationSet;
 
@@ -58,6 +65,21 @@ class HighlightPattern final: private Base::Counter<HighlightPattern>
     //* no parent pattern
     static QString noParentPattern_;
 
+    //*@name budget for patterns that backtrack heavily on long lines
+    /**
+    the budget is a number of steps rather than a time,
+    so that highlighting does not depend on machine load and can be cached
+    */
+    //@{
+
+    //* maximum number of PCRE steps for a single match
+    static const int maxMatchSteps = 100000;
+
+    //* maximum number of matches on a single block
+    static const int maxBlockMatches = 256;
+
+    //@}
+
     //* default constructor
     explicit HighlightPattern();
 
@@ -109,8 +131,12 @@ class HighlightPattern final: private Base::Counter<HighlightPattern>
     const HighlightStyle& style() const
     { return style_; }
 
-    //* child patterns
-    const List& children() const
+    //* text style index, in the document class style table
+    int styleIndex() const
+    { return styleIndex_; }
+
+    //* child pattern ids
+    const QVector<int>& children() const
     { return children_; }
 
     //* keyword regexp
@@ -136,6 +162,60 @@ class HighlightPattern final: private Base::Counter<HighlightPattern>
     //* validity
     bool isValid() const;
 
+    //* true if keyword is matched using a word list rather than the regular expression
+    bool hasWordList() const
+    { return wordList_.isValid(); }
+
+    //* true if regular expressions contain constructs prone to catastrophic backtracking
+    bool isBacktrackingProne() const;
+
+    //@}
+
+    //*@name statistics
+    //@{
+
+    //* number of searches skipped because the text cannot match
+    /** only counted when profiling */
+    int filterSkipCount() const
+    { return statistics_->skipCount_.loadAcquire(); }
+
+    //* number of searches for which the text may match
+    /** only counted when profiling */
+    int filterHitCount() const
+    { return statistics_->hitCount_.loadAcquire(); }
+
+    //* number of blocks for which the pattern exceeded its budget
+    int overBudgetCount() const
+    { return statistics_->overBudgetCount_.loadAcquire(); }
+
+    //* number of locations discarded because they overlap locations of other patterns
+    /** only counted when profiling */
+    int overlapCount() const
+    { return statistics_->overlapCount_.loadAcquire(); }
+
+    //* increment number of locations discarded because of overlaps
+    void addOverlap() const
+    { statistics_->overlapCount_.ref(); }
+
+    //* incremented each time any pattern exceeds its budget
+    /** it is used to check for new over budget patterns without looping over all of them */
+    static int overBudgetSerial()
+    { return overBudgetSerial_.loadAcquire(); }
+
+    //* profiling counters
+    const HighlightProfiler::Counters& profile() const
+    { return statistics_->profile_; }
+
+    //* reset filter statistics and profiling counters
+    void resetStatistics() const
+    {
+        statistics_->skipCount_.storeRelease( 0 );
+        statistics_->hitCount_.storeRelease( 0 );
+        statistics_->overBudgetCount_.storeRelease( 0 );
+        statistics_->overlapCount_.storeRelease( 0 );
+        statistics_->profile_.reset();
+    }
+
     //@}
 
     //*@name modifiers
@@ -143,11 +223,11 @@ class HighlightPattern final: private Base::Counter<HighlightPattern>
 
     //* set id
     /**
-    The unique ID has a single bit set to 1, to use
-    faster active pattern masks, with no shift operators
+    ids are dense indices, starting from 1, so that 0
+    can be used both for 'no pattern' and 'no parent'
     */
     void setId( int id )
-    { id_ = (1<<id); }
+    { id_ = id; }
 
     //* name
     void setName( const QString& name )
@@ -169,9 +249,13 @@ class HighlightPattern final: private Base::Counter<HighlightPattern>
     void setStyle( const HighlightStyle& style )
     { style_ = style; }
 
-    //* add child
-    void addChild( const HighlightPattern &child )
-    { children_ << child; }
+    //* text style index
+    void setStyleIndex( int index )
+    { styleIndex_ = index; }
+
+    //* add child pattern id
+    void addChild( int id )
+    { children_.append( id ); }
 
     //* clear children
     void clearChildren()
@@ -182,6 +266,7 @@ class HighlightPattern final: private Base::Counter<HighlightPattern>
     { 
         keyword_.setPattern( value ); 
         _updatePatternOptions( keyword_ );
+        _updateFilters();
     }
 
     //* keyword
@@ -193,6 +278,7 @@ class HighlightPattern final: private Base::Counter<HighlightPattern>
     { 
         end_.setPattern( value ); 
         _updatePatternOptions( end_ );
+        _updateFilters();
     }
     
     //* keyword
@@ -200,6 +286,7 @@ class HighlightPattern final: private Base::Counter<HighlightPattern>
     {
         keyword_ = value; 
         _updatePatternOptions( keyword_ );
+        _updateFilters();
     }
     
     //* begin
@@ -211,6 +298,7 @@ class HighlightPattern final: private Base::Counter<HighlightPattern>
     {
         end_ = value;
         _updatePatternOptions( end_ );
+        _updateFilters();
     }
 
     //* flags
@@ -219,6 +307,7 @@ class HighlightPattern final: private Base::Counter<HighlightPattern>
         flags_ = flags; 
         _updatePatternOptions( keyword_ );
         _updatePatternOptions( end_ );
+        _updateFilters();
     }
 
     //* flags
@@ -228,21 +317,51 @@ class HighlightPattern final: private Base::Counter<HighlightPattern>
         else flags_ &= (~flag);
         _updatePatternOptions( keyword_ );
         _updatePatternOptions( end_ );
+        _updateFilters();
     }
 
     //* process text and update the matching locations.
     /**
     Returns true if at least one match is found.
+    Matches are looked for in range [from, to), the preceding text being only used as context,
+    for anchors, word boundaries and lookbehinds. Text is considered to end at to.
     Locations and active parameters are changed
     */
-    bool processText( PatternLocationSet& locations, const QString& text, bool& active ) const
+    bool processText( PatternLocationSet& locations, const QString& text, int from, int to, bool& active ) const
     {
-        switch( type_ )
-        {
-            case Type::KeywordPattern: return _findKeyword( locations, text, active );
-            case Type::RangePattern: return _findRange( locations, text, active );
-            default: return false;
-        }
+        if( Q_UNLIKELY( HighlightProfiler::isEnabled() ) ) return _profileText( locations, text, from, to, active );
+
+        // matches are appended, and sorted into the set once
+        const int size( locations.size() );
+        const bool found( _processText( locations, text, from, to, active ) );
+        locations.merge( size );
+        return found;
+    }
+
+    //@}
+
+    //*@name matching
+    //@{
+
+    //* match regular expression in text, from offset, considering that text ends at position to
+    /** text is not copied. The text preceding offset is seen by anchors, word boundaries and lookbehinds */
+    static QRegularExpressionMatch match( const QRegularExpression& regexp, const QString& text, int offset, int to )
+    {
+        #if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
+        return regexp.match( QStringRef( &text, 0, to ), offset );
+        #else
+        return regexp.match( QStringView( text ).left( to ), offset );
+        #endif
+    }
+
+    //* iterate over matches of regular expression in text, from offset, considering that text ends at position to
+    static QRegularExpressionMatchIterator globalMatch( const QRegularExpression& regexp, const QString& text, int offset, int to )
+    {
+        #if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
+        return regexp.globalMatch( QStringRef( &text, 0, to ), offset );
+        #else
+        return regexp.globalMatch( QStringView( text ).left( to ), offset );
+        #endif
     }
 
     //@}
@@ -255,21 +374,65 @@ class HighlightPattern final: private Base::Counter<HighlightPattern>
 
     private:
 
+    //* process text and update the matching locations
+    bool _processText( PatternLocationSet& locations, const QString& text, int from, int to, bool& active ) const
+    {
+        switch( type_ )
+        {
+            case Type::KeywordPattern: return _findKeyword( locations, text, from, to, active );
+            case Type::RangePattern: return _findRange( locations, text, from, to, active );
+            default: return false;
+        }
+    }
+
+    //* process text and update profiling counters
+    bool _profileText( PatternLocationSet&, const QString&, int from, int to, bool& ) const;
+
+    //* discard locations found for this pattern in current block, and record budget overrun
+    /** the block is then left as plain text, as far as this pattern is concerned */
+    bool _discard( PatternLocationSet&, bool& ) const;
+
+    //* true if pattern contains nested unbounded quantifiers, such as (a+)*
+    static bool _hasNestedQuantifiers( const QString& );
+
     //* update pattern options for provided regular expression
     /** explicitly, implements caseinsensitivity */
     void _updatePatternOptions( QRegularExpression& ) const;
+
+    //* update filters, word list and matching expressions from regular expressions
+    void _updateFilters();
+
+    //* regular expression with a bounded number of steps, if it may backtrack heavily
+    static QRegularExpression _bounded( const QRegularExpression& );
+
+    //* first position in [from, to) at which the text may match filter, or -1
+    /** also updates filter statistics */
+    int _filter( const RegularExpressionFilter&, const QString&, int from, int to ) const;
+
+    //* update filter statistics from filtered position
+    /** statistics are shared by all threads, so they are only updated when profiling */
+    void _countFilter( int position ) const
+    {
+        if( Q_LIKELY( !HighlightProfiler::isEnabled() ) ) return;
+        if( position < 0 ) statistics_->skipCount_.ref();
+        else statistics_->hitCount_.ref();
+    }
+
+    //* returned by _findDelimiter when the maximum number of steps is reached
+    static const int matchFailed = -2;
+
+    //* find range delimiter
+    /** returns the delimiter position, -1 or matchFailed, and sets its length */
+    int _findDelimiter( const QRegularExpression&, const RegularExpressionFilter&, const QString&, int from, int to, int& length ) const;
     
     //* find keyword pattern
-    bool _findKeyword( PatternLocationSet&, const QString&, bool& ) const;
+    bool _findKeyword( PatternLocationSet&, const QString&, int from, int to, bool& ) const;
 
     //* find range pattern
-    bool _findRange( PatternLocationSet&, const QString&, bool& ) const;
+    bool _findRange( PatternLocationSet&, const QString&, int from, int to, bool& ) const;
 
     //* unique id
-    /**
-    The unique ID has a single bit set to 1, to use
-    faster active pattern masks, with no shift operators
-    */
+    /** dense index in the document class pattern list, starting from 1 */
     int id_ = 0;
 
     //* type
@@ -287,8 +450,13 @@ class HighlightPattern final: private Base::Counter<HighlightPattern>
     //* style
     HighlightStyle style_;
 
-    //* child patterns
-    List children_;
+    //* style index
+    /** -1 means the style is not part of any style table */
+    int styleIndex_ = -1;
+
+    //* child pattern ids
+    /** patterns are retrieved from the pattern set they belong to */
+    QVector<int> children_;
 
     //* flags
     Flags flags_ = None;
@@ -302,8 +470,54 @@ class HighlightPattern final: private Base::Counter<HighlightPattern>
     //* range end regexp
     QRegularExpression end_;
 
+    //* keyword filter
+    RegularExpressionFilter keywordFilter_;
+
+    //* range end filter
+    RegularExpressionFilter endFilter_;
+
+    //* keyword word list
+    WordListMatcher wordList_;
+
+    //* keyword regexp used for matching
+    /** same as keyword, with a bounded number of steps for patterns that backtrack heavily */
+    QRegularExpression matchKeyword_;
+
+    //* range end regexp used for matching
+    QRegularExpression matchEnd_;
+
+    //* true if matching is bounded
+    bool bounded_ = false;
+
     //@}
 
+    //* filter statistics and profiling counters
+    /** shared between copies, and updated from both the gui and the highlighting threads */
+    class Statistics
+    {
+        public:
+
+        //* skipped searches
+        QAtomicInt skipCount_;
+
+        //* performed searches
+        QAtomicInt hitCount_;
+
+        //* blocks for which budget was exceeded
+        QAtomicInt overBudgetCount_;
+
+        //* locations discarded because of overlaps
+        QAtomicInt overlapCount_;
+
+        //* profiling
+        HighlightProfiler::Counters profile_;
+    };
+
+    std::shared_ptr<Statistics> statistics_;
+
+    //* over budget serial
+    static QAtomicInt overBudgetSerial_;
+
     //*@name dumpers
     //@{
     //* dump
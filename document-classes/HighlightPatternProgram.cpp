@@ -0,0 +1,165 @@
+/******************************************************************************
+*
+* Copyright (C) 2002 Hugo PEREIRA <mailto: hugo.pereira@free.fr>
+*
+* This is free software; you can redistribute it and/or modify it under the
+* terms of the GNU General Public License as published by the Free Software
+* Foundation; either version 2 of the License, or (at your option) any later
+* version.
+*
+* This software is distributed in the hope that it will be useful, but WITHOUT
+* Any WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along with
+* this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*******************************************************************************/
+
+#include "HighlightPatternProgram.h"
+#include "Debug.h"
+
+#include <QStringList>
+
+//___________________________________________________________________________
+HighlightPatternProgram::HighlightPatternProgram():
+    Counter( QStringLiteral("HighlightPatternProgram") )
+{}
+
+//___________________________________________________________________________
+HighlightPatternProgram::HighlightPatternProgram( const HighlightPattern::List& patterns ):
+    Counter( QStringLiteral("HighlightPatternProgram") )
+{
+    Debug::Throw( QStringLiteral("HighlightPatternProgram::HighlightPatternProgram.\n") );
+
+    QStringList alternatives;
+    QStringList lookaheads;
+    int maxId( 0 );
+    int group( 1 );
+    for( const auto& pattern:patterns )
+    {
+        maxId = qMax( maxId, pattern.id() );
+        if( !isMergeable( pattern ) ) continue;
+
+        // case sensitivity is implemented locally to each alternative
+        auto expression( pattern.keyword().pattern() );
+        if( pattern.hasFlag( HighlightPattern::CaseInsensitive ) ) expression = QStringLiteral( "(?i:%1)" ).arg( expression );
+
+        alternatives.append( QStringLiteral( "(%1)" ).arg( expression ) );
+        lookaheads.append( QStringLiteral( "(?:(?=(%1))|)" ).arg( expression ) );
+
+        // store group index and skip pattern own capture groups
+        patterns_.append( pattern );
+        groups_.append( group );
+        group += 1 + pattern.keyword().captureCount();
+    }
+
+    // nothing to gain if less than two patterns are merged
+    if( patterns_.size() < 2 ) return;
+
+    merged_.resize( maxId+1 );
+    for( const auto& pattern:patterns_ )
+    { merged_.setBit( pattern.id() ); }
+
+    regexp_.setPattern( alternatives.join( QLatin1Char( '|' ) ) );
+    overlapRegexp_.setPattern( QStringLiteral( "\\G" ) + lookaheads.join( QString() ) );
+
+    if( !isValid() )
+    {
+        Debug::Throw(0) << "HighlightPatternProgram::HighlightPatternProgram - invalid merged pattern: " << regexp_.errorString() << Qt::endl;
+        patterns_.clear();
+        groups_.clear();
+        merged_.clear();
+    }
+
+}
+
+//___________________________________________________________________________
+bool HighlightPatternProgram::isMergeable( const HighlightPattern& pattern )
+{
+
+    // only valid top level keyword patterns are merged
+    if( pattern.type() != HighlightPattern::Type::KeywordPattern || pattern.parentId() || !pattern.isValid() )
+    { return false; }
+
+    // word lists are faster matched on their own
+    if( pattern.hasWordList() ) return false;
+
+    // slow patterns are processed on their own, so that their budget is checked
+    if( pattern.isBacktrackingProne() ) return false;
+
+    // reject constructs whose meaning would change once embedded in a larger expression:
+    // back references, named groups, inline options, verbs, \G, \K and quoting
+    const auto expression( pattern.keyword().pattern() );
+    for( int i = 0; i < expression.size(); ++i )
+    {
+        const auto current( expression.at(i) );
+        if( current == QLatin1Char( '\\' ) )
+        {
+
+            if( ++i >= expression.size() ) return false;
+            const auto next( expression.at(i) );
+            if( next.isDigit() && next != QLatin1Char( '0' ) ) return false;
+            if( QStringLiteral( "gGkKQE" ).contains( next ) ) return false;
+
+        } else if( current == QLatin1Char( '(' ) && i+1 < expression.size() ) {
+
+            const auto next( expression.at(i+1) );
+            if( next == QLatin1Char( '*' ) ) return false;
+            if( next != QLatin1Char( '?' ) ) continue;
+
+            if( i+2 >= expression.size() ) return false;
+            const auto type( expression.at(i+2) );
+            if( QStringLiteral( ":=!>" ).contains( type ) ) continue;
+            if( type == QLatin1Char( '<' ) && i+3 < expression.size() && QStringLiteral( "=!" ).contains( expression.at(i+3) ) ) continue;
+            return false;
+
+        }
+
+    }
+
+    return true;
+
+}
+
+//___________________________________________________________________________
+bool HighlightPatternProgram::processText( QVector<PatternLocation>& locations, const QString& text, int from, int to ) const
+{
+
+    // patterns are processed one by one if the merged scan fails
+    auto match( HighlightPattern::match( regexp_, text, from, to ) );
+    while( match.hasMatch() )
+    {
+
+        const int position = match.capturedStart();
+        const int end = match.capturedEnd();
+
+        // zero length matches are handled differently by global matching
+        if( end == position ) return false;
+
+        // find first matching alternative
+        int index( 0 );
+        while( index < groups_.size() && match.capturedStart( groups_[index] ) < 0 ) { ++index; }
+        Q_ASSERT( index < groups_.size() );
+
+        // check that no other pattern matches at the same position past the end of current match.
+        // This would prevent it from matching again before its own end, if processed individually
+        const auto overlap( HighlightPattern::match( overlapRegexp_, text, position, to ) );
+        for( int other = index+1; other < groups_.size(); ++other )
+        { if( overlap.capturedEnd( groups_[other] ) > end ) return false; }
+
+        locations.append( PatternLocation( patterns_[index], position, end-position ) );
+
+        // look for next match, starting right after current position
+        // a match that starts before current end would overlap with the current one
+        // and could hide later matches of its own pattern
+        const int next = position + ( text.at( position ).isHighSurrogate() ? 2:1 );
+        match = HighlightPattern::match( regexp_, text, next, to );
+        if( match.hasMatch() && match.capturedStart() < end ) return false;
+
+    }
+
+    // maximum number of PCRE steps was reached
+    return match.isValid();
+}
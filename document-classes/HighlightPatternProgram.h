@@ -0,0 +1,93 @@
+#ifndef HighlightPatternProgram_h
+#define HighlightPatternProgram_h
+
+/******************************************************************************
+*
+* Copyright (C) 2002 Hugo PEREIRA <mailto: hugo.pereira@free.fr>
+*
+* This is free software; you can redistribute it and/or modify it under the
+* terms of the GNU General Public License as published by the Free Software
+* Foundation; either version 2 of the License, or (at your option) any later
+* version.
+*
+* This software is distributed in the hope that it will be useful, but WITHOUT
+* Any WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along with
+* this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*******************************************************************************/
+
+#include "Counter.h"
+#include "HighlightPattern.h"
+#include "PatternLocation.h"
+
+#include <QBitArray>
+#include <QRegularExpression>
+#include <QVector>
+
+//* merges top level keyword patterns into a single regular expression
+/**
+text is then scanned once for all merged patterns, rather than once per pattern.
+Whenever the merged scan cannot guarantee the same locations as processing patterns one by one
+(zero length matches, matches starting inside another match), processText returns false and the caller
+must fall back to processing patterns individually
+*/
+class HighlightPatternProgram final: private Base::Counter<HighlightPatternProgram>
+{
+
+    public:
+
+    //* default constructor
+    explicit HighlightPatternProgram();
+
+    //* constructor from pattern list
+    explicit HighlightPatternProgram( const HighlightPattern::List& );
+
+    //*@name accessors
+    //@{
+
+    //* validity
+    bool isValid() const
+    { return patterns_.size() > 1 && regexp_.isValid() && overlapRegexp_.isValid(); }
+
+    //* true if pattern matching id is handled by the program
+    bool contains( int id ) const
+    { return id >= 0 && id < merged_.size() && merged_.testBit( id ); }
+
+    //* merged patterns
+    const HighlightPattern::List& patterns() const
+    { return patterns_; }
+
+    //* process text in range [from, to), and store matching locations
+    /** returns false if text must be processed pattern by pattern */
+    bool processText( QVector<PatternLocation>&, const QString&, int from, int to ) const;
+
+    //@}
+
+    //* true if pattern can be merged with others
+    static bool isMergeable( const HighlightPattern& );
+
+    private:
+
+    //* merged patterns
+    HighlightPattern::List patterns_;
+
+    //* capture group index, for each merged pattern
+    QVector<int> groups_;
+
+    //* merged pattern ids
+    QBitArray merged_;
+
+    //* alternation of all merged patterns
+    QRegularExpression regexp_;
+
+    //* anchored lookahead of all merged patterns
+    /** it is used to find all patterns that match at a given position */
+    QRegularExpression overlapRegexp_;
+
+};
+
+#endif
@@ -0,0 +1,34 @@
+/******************************************************************************
+*
+* Copyright (C) 2002 Hugo PEREIRA <mailto: hugo.pereira@free.fr>
+*
+* This is free software; you can redistribute it and/or modify it under the
+* terms of the GNU General Public License as published by the Free Software
+* Foundation; either version 2 of the License, or (at your option) any later
+* version.
+*
+* This software is distributed in the hope that it will be useful, but WITHOUT
+* Any WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along with
+* this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*******************************************************************************/
+
+#include "HighlightPatternSet.h"
+
+//___________________________________________________________________________
+HighlightPatternSet::HighlightPatternSet( const HighlightPattern::List& patterns ):
+    Counter( QStringLiteral("HighlightPatternSet") ),
+    patterns_( patterns ),
+    program_( patterns )
+{}
+
+//___________________________________________________________________________
+const HighlightPatternSet::Pointer& HighlightPatternSet::emptySet()
+{
+    static const Pointer empty( std::make_shared<const HighlightPatternSet>() );
+    return empty;
+}
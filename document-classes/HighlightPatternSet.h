@@ -0,0 +1,84 @@
+#ifndef HighlightPatternSet_h
+#define HighlightPatternSet_h
+
+/******************************************************************************
+*
+* Copyright (C) 2002 Hugo PEREIRA <mailto: hugo.pereira@free.fr>
+*
+* This is free software; you can redistribute it and/or modify it under the
+* terms of the GNU General Public License as published by the Free Software
+* Foundation; either version 2 of the License, or (at your option) any later
+* version.
+*
+* This software is distributed in the hope that it will be useful, but WITHOUT
+* Any WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along with
+* this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*******************************************************************************/
+#include "Counter.h"
+#include "HighlightPattern.h"
+#include "HighlightPatternProgram.h"
+
+#include <memory>
+
+//* compiled highlight patterns of a document class
+/**
+sets are immutable. They are created once per document class, and shared by all highlighters
+using the class, together with their highlighting threads, rather than copied.
+Patterns refer to their children by id, so that each pattern is stored only once
+*/
+class HighlightPatternSet final: private Base::Counter<HighlightPatternSet>
+{
+
+    public:
+
+    //* shared pointer
+    using Pointer = std::shared_ptr<const HighlightPatternSet>;
+
+    //* constructor
+    /** pattern ids must be dense, starting from 1, and parent/children hierarchy must be set */
+    explicit HighlightPatternSet( const HighlightPattern::List& = HighlightPattern::List() );
+
+    //* shared empty set
+    static const Pointer& emptySet();
+
+    //*@name accessors
+    //@{
+
+    //* patterns
+    const HighlightPattern::List& patterns() const
+    { return patterns_; }
+
+    //* merged keyword patterns
+    const HighlightPatternProgram& program() const
+    { return program_; }
+
+    //* true if empty
+    bool empty() const
+    { return patterns_.empty(); }
+
+    //* number of patterns
+    int size() const
+    { return patterns_.size(); }
+
+    //* pattern matching id, if any
+    const HighlightPattern* find( int id ) const
+    { return ( id > 0 && id <= patterns_.size() ) ? &patterns_[id-1]:nullptr; }
+
+    //@}
+
+    private:
+
+    //* patterns
+    HighlightPattern::List patterns_;
+
+    //* merged keyword patterns
+    HighlightPatternProgram program_;
+
+};
+
+#endif
@@ -0,0 +1,51 @@
+/******************************************************************************
+*
+* Copyright (C) 2002 Hugo PEREIRA <mailto: hugo.pereira@free.fr>
+*
+* This is free software; you can redistribute it and/or modify it under the
+* terms of the GNU General Public License as published by the Free Software
+* Foundation; either version 2 of the License, or (at your option) any later
+* version.
+*
+* This software is distributed in the hope that it will be useful, but WITHOUT
+* Any WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along with
+* this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*******************************************************************************/
+
+#include "HighlightProfiler.h"
+
+//___________________________________________________________________________
+QAtomicInt HighlightProfiler::enabled_( 0 );
+
+//___________________________________________________________________________
+HighlightProfiler::Counters& HighlightProfiler::blockCounters()
+{
+    static Counters counters;
+    return counters;
+}
+
+//___________________________________________________________________________
+void HighlightProfiler::Counters::add( qint64 time, int matches )
+{
+    invocations_.fetchAndAddRelaxed( 1 );
+    matches_.fetchAndAddRelaxed( matches );
+    time_.fetchAndAddRelaxed( time );
+
+    // update worst time
+    for( qint64 worstTime = worstTime_.loadRelaxed(); time > worstTime && !worstTime_.testAndSetRelaxed( worstTime, time, worstTime ); )
+    {}
+}
+
+//___________________________________________________________________________
+void HighlightProfiler::Counters::reset()
+{
+    invocations_.storeRelaxed( 0 );
+    matches_.storeRelaxed( 0 );
+    time_.storeRelaxed( 0 );
+    worstTime_.storeRelaxed( 0 );
+}
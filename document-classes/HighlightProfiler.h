@@ -0,0 +1,178 @@
+#ifndef HighlightProfiler_h
+#define HighlightProfiler_h
+
+/******************************************************************************
+*
+* Copyright (C) 2002 Hugo PEREIRA <mailto: hugo.pereira@free.fr>
+*
+* This is free software; you can redistribute it and/or modify it under the
+* terms of the GNU General Public License as published by the Free Software
+* Foundation; either version 2 of the License, or (at your option) any later
+* version.
+*
+* This software is distributed in the hope that it will be useful, but WITHOUT
+* Any WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along with
+* this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*******************************************************************************/
+
+#include <QAtomicInt>
+#include <QAtomicInteger>
+#include <QString>
+
+//* optional profiling of syntax highlighting
+/**
+when enabled, each highlight pattern records the time spent processing text blocks,
+and TextHighlight records the time spent highlighting blocks as a whole.
+When disabled, the only cost is a relaxed atomic load per pattern and per block
+*/
+class HighlightProfiler final
+{
+
+    public:
+
+    //* true if profiling is enabled
+    static bool isEnabled()
+    { return enabled_.loadRelaxed(); }
+
+    //* enable profiling
+    static void setEnabled( bool value )
+    { enabled_.storeRelaxed( value ); }
+
+    //* profiling counters
+    /** counters can be updated concurrently from the gui and the highlighting threads */
+    class Counters final
+    {
+
+        public:
+
+        //*@name accessors
+        //@{
+
+        //* number of processed blocks
+        qint64 invocations() const
+        { return invocations_.loadRelaxed(); }
+
+        //* number of matches
+        qint64 matches() const
+        { return matches_.loadRelaxed(); }
+
+        //* total time, in nanoseconds
+        qint64 time() const
+        { return time_.loadRelaxed(); }
+
+        //* worst time for a single block, in nanoseconds
+        qint64 worstTime() const
+        { return worstTime_.loadRelaxed(); }
+
+        //@}
+
+        //*@name modifiers
+        //@{
+
+        //* add processed block
+        void add( qint64 time, int matches );
+
+        //* reset
+        void reset();
+
+        //@}
+
+        private:
+
+        QAtomicInteger<qint64> invocations_;
+        QAtomicInteger<qint64> matches_;
+        QAtomicInteger<qint64> time_;
+        QAtomicInteger<qint64> worstTime_;
+
+    };
+
+    //* block counters, for all highlighted documents
+    static Counters& blockCounters();
+
+    private:
+
+    //* enabled state
+    static QAtomicInt enabled_;
+
+};
+
+//* profiling counters of a given highlight pattern, copied for display
+class HighlightPatternProfile final
+{
+
+    public:
+
+    //* constructor
+    explicit HighlightPatternProfile() = default;
+
+    //* constructor
+    explicit HighlightPatternProfile( const QString& className, const QString& name, const HighlightProfiler::Counters& counters, int skipCount = 0, int overBudgetCount = 0 ):
+        className_( className ),
+        name_( name ),
+        invocations_( counters.invocations() ),
+        matches_( counters.matches() ),
+        time_( counters.time() ),
+        worstTime_( counters.worstTime() ),
+        skipCount_( skipCount ),
+        overBudgetCount_( overBudgetCount )
+    {}
+
+    //* document class name
+    const QString& className() const
+    { return className_; }
+
+    //* pattern name
+    const QString& name() const
+    { return name_; }
+
+    //* number of processed blocks
+    qint64 invocations() const
+    { return invocations_; }
+
+    //* number of matches
+    qint64 matches() const
+    { return matches_; }
+
+    //* total time, in nanoseconds
+    qint64 time() const
+    { return time_; }
+
+    //* average time per block, in nanoseconds
+    qint64 averageTime() const
+    { return invocations_ > 0 ? time_/invocations_:0; }
+
+    //* worst time for a single block, in nanoseconds
+    qint64 worstTime() const
+    { return worstTime_; }
+
+    //* number of regular expression searches skipped by the pattern filters
+    int skipCount() const
+    { return skipCount_; }
+
+    //* number of blocks for which the budget was exceeded
+    int overBudgetCount() const
+    { return overBudgetCount_; }
+
+    //* equal to operator
+    friend bool operator == ( const HighlightPatternProfile& first, const HighlightPatternProfile& second )
+    { return first.className_ == second.className_ && first.name_ == second.name_; }
+
+    private:
+
+    QString className_;
+    QString name_;
+    qint64 invocations_ = 0;
+    qint64 matches_ = 0;
+    qint64 time_ = 0;
+    qint64 worstTime_ = 0;
+    int skipCount_ = 0;
+    int overBudgetCount_ = 0;
+
+};
+
+#endif
@@ -59,6 +59,21 @@ QDomElement HighlightStyle::domElement( QDomDocument& parent ) const
     return out;
 }
 
+//_____________________________________________________
+QTextCharFormat HighlightStyle::format() const
+{
+
+    QTextCharFormat out;
+    out.setFontWeight( (format_&TextFormat::Bold) ? QFont::Bold : QFont::Normal );
+    out.setFontItalic( format_&TextFormat::Italic );
+    out.setFontUnderline( format_&TextFormat::Underline );
+    out.setFontOverline( format_&TextFormat::Overline );
+    out.setFontStrikeOut( format_&TextFormat::Strike );
+    if( color_.isValid() ) out.setForeground( color_ );
+    if( backgroundColor_.isValid() ) out.setBackground( backgroundColor_ );
+
+    return out;
+}
 
 //_____________________________________________________
 bool operator == ( const HighlightStyle& first, const HighlightStyle& second)
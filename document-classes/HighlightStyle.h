@@ -31,6 +31,7 @@
 #include <QString>
 #include <QSet>
 #include <QList>
+#include <QTextCharFormat>
 
 //* Base class for syntax highlighting
 class HighlightStyle final: private Base::Counter<HighlightStyle>
@@ -66,6 +67,9 @@ class HighlightStyle final: private Base::Counter<HighlightStyle>
     const QColor& color() const
     { return color_; }
 
+    //* formated font
+    QTextCharFormat format() const;
+
     //@}
 
     //!@name modifiers
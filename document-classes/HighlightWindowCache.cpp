@@ -0,0 +1,116 @@
+/******************************************************************************
+*
+* Copyright (C) 2002 Hugo PEREIRA <mailto: hugo.pereira@free.fr>
+*
+* This is free software; you can redistribute it and/or modify it under the
+* terms of the GNU General Public License as published by the Free Software
+* Foundation; either version 2 of the License, or (at your option) any later
+* version.
+*
+* This software is distributed in the hope that it will be useful, but WITHOUT
+* Any WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along with
+* this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*******************************************************************************/
+
+#include "HighlightWindowCache.h"
+
+#include <QStringView>
+
+#include <array>
+
+namespace
+{
+
+    //* random values, one per character low byte, for the boundary rolling hash
+    using GearTable = std::array<quint32, 256>;
+    const GearTable& gearTable()
+    {
+        static const GearTable table = []()
+        {
+            GearTable out;
+            quint32 value( 0x9e3779b9 );
+            for( auto& gear:out )
+            {
+                value ^= value << 13;
+                value ^= value >> 17;
+                value ^= value << 5;
+                gear = value;
+            }
+            return out;
+        }();
+
+        return table;
+    }
+
+}
+
+//___________________________________________________________________________
+HighlightWindowCache::HighlightWindowCache():
+    Counter( QStringLiteral("HighlightWindowCache") )
+{}
+
+//___________________________________________________________________________
+int HighlightWindowCache::candidate( const QString& text, int from, int to )
+{
+
+    // the hash only depends on the last 32 characters, since older ones are shifted out.
+    // Boundaries are found on average every 1024 characters.
+    // High bits are used, because low bits only depend on the very last characters
+    static const quint32 mask( 0xffc00000 );
+    const auto& gears( gearTable() );
+
+    to = qMin( to, text.size() );
+    quint32 hash( 0 );
+    for( int i = qMax( 0, from-32 ); i < to; ++i )
+    {
+        hash = ( hash << 1 ) + gears[text.at(i).unicode() & 0xff];
+        if( i >= from && !( hash & mask ) ) return i;
+    }
+
+    return -1;
+
+}
+
+//___________________________________________________________________________
+bool HighlightWindowCache::isCovered( const PatternLocationSet& locations, int position )
+{
+    // locations are sorted by position
+    for( const auto& location:locations )
+    {
+        if( location.position() >= position ) break;
+        if( location.position() + location.length() > position ) return true;
+    }
+
+    return false;
+}
+
+//___________________________________________________________________________
+quint64 HighlightWindowCache::key( const QString& text, int position, int length )
+{
+    // two seeds, for a 64 bits key also on platforms where qHash returns 32 bits
+    // the preceding context is hashed together with the window
+    const int first( qMax( 0, position - context ) );
+    const auto segment( QStringView( text ).mid( first, position + length - first ) );
+    return ( quint64( qHash( segment, 0 ) ) << 32 ) ^ quint64( quint32( qHash( segment, 0x9e3779b9 ) ) );
+}
+
+//___________________________________________________________________________
+const HighlightWindowCache::Window* HighlightWindowCache::find( quint64 key, int segmentLength, int activeId ) const
+{
+    const auto iter( windows_.constFind( key ) );
+    if( iter == windows_.constEnd() ) return nullptr;
+    if( iter->segmentLength_ != segmentLength || iter->firstActiveId_ != activeId ) return nullptr;
+    return &iter.value();
+}
+
+//___________________________________________________________________________
+void HighlightWindowCache::insert( quint64 key, const Window& window )
+{
+    if( windows_.size() >= maxWindows ) windows_.clear();
+    windows_.insert( key, window );
+}
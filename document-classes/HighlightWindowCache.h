@@ -0,0 +1,128 @@
+#ifndef HighlightWindowCache_h
+#define HighlightWindowCache_h
+
+/******************************************************************************
+*
+* Copyright (C) 2002 Hugo PEREIRA <mailto: hugo.pereira@free.fr>
+*
+* This is free software; you can redistribute it and/or modify it under the
+* terms of the GNU General Public License as published by the Free Software
+* Foundation; either version 2 of the License, or (at your option) any later
+* version.
+*
+* This software is distributed in the hope that it will be useful, but WITHOUT
+* Any WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along with
+* this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*******************************************************************************/
+
+#include "Counter.h"
+#include "PatternLocationSet.h"
+#include "TextBlockDelimiter.h"
+
+#include <QHash>
+#include <QString>
+
+//* highlighted windows of long blocks
+/**
+long blocks, such as minified files or single line logs, are highlighted window by window,
+as if windows were consecutive blocks. Window boundaries depend only on the surrounding text,
+so that after an edit, windows located before and after the edit point are found in the cache
+rather than highlighted again
+*/
+class HighlightWindowCache final: private Base::Counter<HighlightWindowCache>
+{
+
+    public:
+
+    //* constructor
+    explicit HighlightWindowCache();
+
+    //* highlighted window
+    class Window final
+    {
+        public:
+
+        //* processed text length, used as window key together with its hash
+        int segmentLength_ = 0;
+
+        //* active id at the beginning of the window
+        int firstActiveId_ = 0;
+
+        //* window length, which is at most the processed length
+        int length_ = 0;
+
+        //* active id at the end of the window
+        int activeId_ = 0;
+
+        //* locations, relative to the window start
+        PatternLocationSet locations_;
+
+        //* block delimiters
+        TextBlock::Delimiter::List delimiters_;
+
+    };
+
+    //*@name window boundaries
+    //@{
+
+    //* minimum window length
+    static const int minLength = 2048;
+
+    //* maximum window length
+    static const int maxLength = 8192;
+
+    //* text processed past a candidate boundary
+    /** locations that would cross the boundary are found, in which case the next candidate is used */
+    static const int margin = 512;
+
+    //* first candidate boundary in text, in range [from, to), or -1
+    /** candidates are selected from a rolling hash of the preceding characters only */
+    static int candidate( const QString&, int from, int to );
+
+    //* true if position is strictly inside one of the locations
+    static bool isCovered( const PatternLocationSet&, int position );
+
+    //@}
+
+    //*@name cache
+    //@{
+
+    //* number of characters preceding a window that are part of its key
+    /**
+    windows are highlighted with the preceding text visible to word boundaries and lookbehinds.
+    Lookbehinds longer than this are not accounted for
+    */
+    static const int context = 64;
+
+    //* key
+    static quint64 key( const QString&, int position, int length );
+
+    //* find window matching key, processed length and active id
+    const Window* find( quint64 key, int segmentLength, int activeId ) const;
+
+    //* insert window
+    void insert( quint64 key, const Window& );
+
+    //* clear
+    void clear()
+    { windows_.clear(); }
+
+    //@}
+
+    private:
+
+    //* maximum number of windows
+    /** the cache is cleared when it is reached */
+    static const int maxWindows = 4096;
+
+    //* windows
+    QHash<quint64, Window> windows_;
+
+};
+
+#endif
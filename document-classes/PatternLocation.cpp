@@ -19,36 +19,12 @@
 
 #include "PatternLocation.h"
 
-//_____________________________________________________
-PatternLocation::PatternLocation():
-    Counter( QStringLiteral("PatternLocation") )
-{}
-
 //_____________________________________________________
 PatternLocation::PatternLocation( const HighlightPattern& parent, int position, int length ):
-    Counter( QStringLiteral("PatternLocation") ),
     id_( parent.id() ),
     parentId_( parent.parentId() ),
-    flags_( parent.flags() ),
-    format_( parent.style().fontFormat() ),
-    color_( parent.style().color() ),
-    backgroundColor_( parent.style().backgroundColor() ),
     position_( position ),
-    length_( length )
+    length_( length ),
+    styleIndex_( static_cast<quint16>( parent.styleIndex() ) ),
+    flags_( static_cast<quint16>( parent.flags() ) )
 {}
-
-//_____________________________________________________
-QTextCharFormat PatternLocation::format() const
-{
-
-    QTextCharFormat out;
-    out.setFontWeight( (format_&TextFormat::Bold) ? QFont::Bold : QFont::Normal );
-    out.setFontItalic( format_&TextFormat::Italic );
-    out.setFontUnderline( format_&TextFormat::Underline );
-    out.setFontOverline( format_&TextFormat::Overline );
-    out.setFontStrikeOut( format_&TextFormat::Strike );
-    if( color_.isValid() ) out.setForeground( color_ );
-    if( backgroundColor_.isValid() ) out.setBackground( backgroundColor_ );
-
-    return out;
-}
@@ -20,23 +20,22 @@
 *
 *******************************************************************************/
 
-#include "Counter.h"
 #include "HighlightPattern.h"
-#include "QOrderedSet.h"
-#include "TextFormat.h"
 
-#include <QTextCharFormat>
+#include <QDataStream>
+#include <QTypeInfo>
 
-//* encapsulate highlight location, pattern and style
-class PatternLocation final: private Base::Counter<PatternLocation>
+//* encapsulate highlight location, pattern and style index
+/**
+the style itself is stored in the document class style table,
+so that locations remain small and can be stored in contiguous buffers
+*/
+class PatternLocation final
 {
     public:
 
-
-    using SetIterator = QOrderedSetIterator<PatternLocation>;
-
     //* construtor
-    explicit PatternLocation();
+    explicit PatternLocation() = default;
 
     //* constructor
     explicit PatternLocation( const HighlightPattern&, int, int );
@@ -56,7 +55,6 @@ class PatternLocation final: private Base::Counter<PatternLocation>
     int length() const
     { return length_; }
 
-
     //* pattern id
     int id() const
     { return id_; }
@@ -65,24 +63,27 @@ class PatternLocation final: private Base::Counter<PatternLocation>
     int parentId() const
     { return parentId_; }
 
+    //* style index
+    int styleIndex() const
+    { return styleIndex_; }
+
     //* flags
     HighlightPattern::Flags flags() const
-    { return flags_; }
+    { return HighlightPattern::Flags( QFlag( flags_ ) ); }
 
     //* flags
     bool hasFlag( HighlightPattern::Flag flag ) const
-    { return flags() & flag; }
+    { return flags_ & flag; }
 
-    //* format
-    TextFormat::Flags fontFormat() const
-    { return format_; }
+    //@}
 
-    //* color
-    QColor color() const
-    { return color_; }
+    //*@name modifiers
+    //@{
 
-    //* formated font
-    QTextCharFormat format() const;
+    //* position
+    /** used to move locations found in part of a text */
+    void setPosition( int value )
+    { position_ = value; }
 
     //@}
 
@@ -134,24 +135,18 @@ class PatternLocation final: private Base::Counter<PatternLocation>
     //* pattern parent id
     int parentId_ = 0;
 
-    //* pattern flags
-    HighlightPattern::Flags flags_ = {};
-
-    //* style font format
-    TextFormat::Flags format_ = {};
-
-    //* style color
-    QColor color_;
-
-    //* background color
-    QColor backgroundColor_;
-    
     //* position in text
     int position_ = 0;
 
     //* length of the pattern
     int length_ = 0;
 
+    //* style index
+    quint16 styleIndex_ = 0;
+
+    //* pattern flags
+    quint16 flags_ = 0;
+
     //* dump
     friend QTextStream& operator << (QTextStream& out, const PatternLocation& location )
     {
@@ -159,8 +154,34 @@ class PatternLocation final: private Base::Counter<PatternLocation>
         return out;
     }
 
+    //*@name serialization
+    //@{
+
+    //* write
+    friend QDataStream& operator << (QDataStream& out, const PatternLocation& location )
+    {
+        out << qint32( location.id_ ) << qint32( location.parentId_ ) << qint32( location.position_ ) << qint32( location.length_ ) << location.styleIndex_ << location.flags_;
+        return out;
+    }
+
+    //* read
+    friend QDataStream& operator >> (QDataStream& in, PatternLocation& location )
+    {
+        qint32 id, parentId, position, length;
+        in >> id >> parentId >> position >> length >> location.styleIndex_ >> location.flags_;
+        location.id_ = id;
+        location.parentId_ = parentId;
+        location.position_ = position;
+        location.length_ = length;
+        return in;
+    }
+
+    //@}
+
 };
 
+Q_DECLARE_TYPEINFO( PatternLocation, Q_PRIMITIVE_TYPE );
+
 //* less than operator
 inline bool operator < (const PatternLocation& first, const PatternLocation& second)
 {
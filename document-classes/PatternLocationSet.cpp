@@ -19,12 +19,89 @@
 
 #include "PatternLocationSet.h"
 
-#include <algorithm>
-
 //______________________________________________________________
 bool PatternLocationSet::isCommented( int position ) const
 {
-    auto iter( std::find_if( set_.constBegin(), set_.constEnd(), PatternLocation::ContainsFTor( position ) ) );
-    if( iter == set_.constEnd() ) return false;
+    auto iter( std::find_if( locations_.begin(), locations_.end(), PatternLocation::ContainsFTor( position ) ) );
+    if( iter == locations_.end() ) return false;
     else return iter->hasFlag( HighlightPattern::Comment );
 }
+
+//______________________________________________________________
+bool PatternLocationSet::isCommented( int position, int& index ) const
+{
+    // skip locations that end before position. They cannot contain the following positions either
+    while( index < locations_.size() && locations_[index].position() + int(locations_[index].length()) <= position ) ++index;
+
+    // locations being sorted, with parents first, the remaining first location is the only candidate
+    return
+        index < locations_.size() &&
+        locations_[index].position() <= position &&
+        locations_[index].hasFlag( HighlightPattern::Comment );
+}
+
+//______________________________________________________________
+bool PatternLocationSet::isSame( const PatternLocationSet& other ) const
+{
+    return
+        activeId_ == other.activeId_ &&
+        std::equal( locations_.begin(), locations_.end(), other.locations_.begin(), other.locations_.end(),
+        []( const PatternLocation& first, const PatternLocation& second )
+        {
+            return
+                first.id() == second.id() &&
+                first.position() == second.position() &&
+                first.length() == second.length();
+        } );
+}
+
+//______________________________________________________________
+bool PatternLocationSet::insert( const PatternLocation& location )
+{
+    // locations are most often inserted in increasing order
+    if( locations_.isEmpty() || locations_.last() < location )
+    {
+        locations_.append( location );
+        return true;
+    }
+
+    const auto iter( std::lower_bound( locations_.begin(), locations_.end(), location ) );
+    if( iter != locations_.end() && *iter == location ) return false;
+
+    locations_.insert( iter, location );
+    return true;
+}
+
+//______________________________________________________________
+bool PatternLocationSet::remove( const PatternLocation& location )
+{
+    const auto iter( std::lower_bound( locations_.begin(), locations_.end(), location ) );
+    if( iter == locations_.end() || !( *iter == location ) ) return false;
+
+    locations_.erase( iter );
+    return true;
+}
+
+//______________________________________________________________
+void PatternLocationSet::removeAll( int id )
+{
+    // collect ids of child patterns, recursively
+    QVarLengthArray<int, 8> ids;
+    ids.append( id );
+    for( bool changed = true; changed; )
+    {
+        changed = false;
+        for( const auto& location:locations_ )
+        {
+            if( location.parentId() && ids.contains( location.parentId() ) && !ids.contains( location.id() ) )
+            {
+                ids.append( location.id() );
+                changed = true;
+            }
+        }
+    }
+
+    const auto iter( std::remove_if( locations_.begin(), locations_.end(),
+        [&ids]( const PatternLocation& location ) { return ids.contains( location.id() ); } ) );
+    locations_.resize( std::distance( locations_.begin(), iter ) );
+}
@@ -21,26 +21,39 @@
 *******************************************************************************/
 
 #include "PatternLocation.h"
-#include "QOrderedSet.h"
 
+#include <QVarLengthArray>
+#include <QVector>
 
-//* set of pattern locations
+#include <algorithm>
+
+//* sorted set of pattern locations
+/**
+locations are stored in a contiguous buffer, sorted by position and parent id,
+with no duplicates. A small number of locations is stored inline, with no heap allocation
+*/
 class PatternLocationSet final
 {
 
     public:
 
+    //* container
+    using Container = QVarLengthArray<PatternLocation, 4>;
+
+    //* compact copy
+    class Compact;
+
     //* default constructor
     explicit PatternLocationSet():
         activeId_( std::make_pair( 0, 0 ) )
     {}
 
+    //* constructor from compact copy
+    explicit inline PatternLocationSet( const Compact& );
+
     //*@name accessors
     //@{
 
-    //* set
-    const QOrderedSet<PatternLocation>& get() const { return set_; }
-
     //* active id
     const std::pair<int,int>& activeId() const
     { return activeId_; }
@@ -48,45 +61,95 @@ class PatternLocationSet final
     //* return true if current position corresponds to commented text
     bool isCommented( int ) const;
 
-    using const_iterator = QOrderedSet<PatternLocation>::const_iterator;
-    const_iterator begin() const { return set_.begin(); }
-    const_iterator end() const { return set_.end(); }
-    const_iterator find( const PatternLocation& location ) const { return set_.find( location ); }
+    //* return true if current position corresponds to commented text
+    /**
+    index is the first location that might contain the position. It is updated so that
+    consecutive calls with increasing positions walk through the locations only once
+    */
+    bool isCommented( int, int& index ) const;
+
+    //* return true if active ids and all locations match those of argument
+    /** unlike location equality, this also compares pattern ids and lengths */
+    bool isSame( const PatternLocationSet& ) const;
 
-    int size() const { return set_.size(); }
-    bool empty() const { return set_.empty(); }
+    using const_iterator = Container::const_iterator;
+    const_iterator begin() const { return locations_.begin(); }
+    const_iterator end() const { return locations_.end(); }
+
+    //* find location matching argument position and parent id
+    const_iterator find( const PatternLocation& location ) const
+    {
+        const auto iter( std::lower_bound( locations_.begin(), locations_.end(), location ) );
+        return ( iter != locations_.end() && *iter == location ) ? iter : locations_.end();
+    }
+
+    int size() const { return locations_.size(); }
+    bool empty() const { return locations_.isEmpty(); }
+
+    //* location at given index
+    const PatternLocation& operator[] ( int index ) const
+    { return locations_[index]; }
 
     //@}
 
     //*@name modifiers
     //@{
 
-    //* set
-    QOrderedSet<PatternLocation>& get() { return set_; }
-
     //* active id
     std::pair<int,int>& activeId()
     { return activeId_; }
 
-    using iterator = QOrderedSet<PatternLocation>::iterator;
-    iterator begin() { return set_.begin(); }
-    iterator end() { return set_.end(); }
+    using iterator = Container::iterator;
+    iterator begin() { return locations_.begin(); }
+    iterator end() { return locations_.end(); }
 
-    const_iterator insert( const PatternLocation& location ) { return set_.insert( location ); }
-    bool remove( const PatternLocation& location ) { return set_.remove( location ); }
+    //* location at given index
+    PatternLocation& operator[] ( int index )
+    { return locations_[index]; }
 
-    //* clear
-    void clear() { set_.clear(); }
+    //* insert location, unless one already exists with the same position and parent id
+    /** returns true if inserted */
+    bool insert( const PatternLocation& );
+
+    //* append location, with no ordering nor uniqueness check
+    /** merge must be called before the set is used again */
+    void append( const PatternLocation& location )
+    { locations_.append( location ); }
+
+    //* sort locations appended after given size into the set
+    /**
+    of locations with the same position and parent id, the first one is kept,
+    unless the replace predicate, called with kept location and next one, returns true.
+    This is the same as inserting locations one by one, with a single sort
+    */
+    template<class Replace>
+    void merge( int size, Replace replace );
+
+    //* sort locations appended after given size into the set, dropping duplicates
+    void merge( int size )
+    { merge( size, []( const PatternLocation&, const PatternLocation& ) { return false; } ); }
 
-    //* erase
-    template<class T> iterator erase(const T& t) { return set_.erase( t ); }
+    //* remove location matching argument position and parent id
+    bool remove( const PatternLocation& );
+
+    //* remove all locations matching a given pattern id
+    /** locations whose chain of parents leads to this pattern are removed as well */
+    void removeAll( int id );
+
+    //* resize
+    /** used to truncate the set after in-place pruning */
+    void resize( int size )
+    { locations_.resize( size ); }
+
+    //* clear
+    void clear() { locations_.clear(); }
 
     //@}
 
     private:
 
-    //* set
-    QOrderedSet<PatternLocation> set_;
+    //* locations
+    Container locations_;
 
     //* active patterns from previous and this paragraph
     std::pair<int, int> activeId_;
@@ -102,4 +165,111 @@ class PatternLocationSet final
 
 };
 
+//* compact copy of a location set, for storage in text blocks
+/**
+locations are stored in a heap buffer of the exact size, and empty sets share the same
+empty buffer, so that blocks with no locations cost no more than a pointer and the active ids
+*/
+class PatternLocationSet::Compact final
+{
+
+    public:
+
+    //* default constructor
+    explicit Compact() = default;
+
+    //* constructor
+    explicit Compact( const PatternLocationSet& locations ):
+        locations_( locations.begin(), locations.end() ),
+        activeId_( locations.activeId() )
+    {}
+
+    //*@name accessors
+    //@{
+
+    //* active ids
+    const std::pair<int,int>& activeId() const
+    { return activeId_; }
+
+    using const_iterator = QVector<PatternLocation>::const_iterator;
+    const_iterator begin() const { return locations_.begin(); }
+    const_iterator end() const { return locations_.end(); }
+
+    int size() const { return locations_.size(); }
+    bool empty() const { return locations_.isEmpty(); }
+
+    //* contiguous locations
+    const PatternLocation* data() const
+    { return locations_.constData(); }
+
+    //@}
+
+    private:
+
+    //* locations
+    QVector<PatternLocation> locations_;
+
+    //* active ids
+    std::pair<int,int> activeId_ = std::make_pair( 0, 0 );
+
+    //*@name serialization
+    //@{
+
+    //* write
+    friend QDataStream& operator << (QDataStream& out, const Compact& locations )
+    {
+        out << qint32( locations.activeId_.first ) << qint32( locations.activeId_.second ) << locations.locations_;
+        return out;
+    }
+
+    //* read
+    friend QDataStream& operator >> (QDataStream& in, Compact& locations )
+    {
+        qint32 first, second;
+        in >> first >> second >> locations.locations_;
+        locations.activeId_ = std::make_pair( first, second );
+        return in;
+    }
+
+    //@}
+
+};
+
+//______________________________________________________________
+template<class Replace>
+void PatternLocationSet::merge( int size, Replace replace )
+{
+    if( size >= locations_.size() ) return;
+    const auto first( locations_.begin() + size );
+
+    // sort appended locations. Sort is stable, so that duplicates keep their insertion order
+    if( !std::is_sorted( first, locations_.end() ) ) std::stable_sort( first, locations_.end() );
+
+    // merge with existing locations, which come first among duplicates
+    auto from( first );
+    if( size > 0 )
+    {
+        if( *first < *(first-1) )
+        {
+            std::inplace_merge( locations_.begin(), first, locations_.end() );
+            from = locations_.begin();
+        } else from = first-1;
+    }
+
+    // remove duplicates
+    auto kept( from );
+    for( auto iter = from+1; iter != locations_.end(); ++iter )
+    {
+        if( !( *iter == *kept ) ) *(++kept) = *iter;
+        else if( replace( *kept, *iter ) ) *kept = *iter;
+    }
+
+    locations_.resize( std::distance( locations_.begin(), kept ) + 1 );
+}
+
+//______________________________________________________________
+PatternLocationSet::PatternLocationSet( const Compact& locations ):
+    activeId_( locations.activeId() )
+{ locations_.append( locations.data(), locations.size() ); }
+
 #endif
@@ -0,0 +1,571 @@
+/******************************************************************************
+*
+* Copyright (C) 2002 Hugo PEREIRA <mailto: hugo.pereira@free.fr>
+*
+* This is free software; you can redistribute it and/or modify it under the
+* terms of the GNU General Public License as published by the Free Software
+* Foundation; either version 2 of the License, or (at your option) any later
+* version.
+*
+* This software is distributed in the hope that it will be useful, but WITHOUT
+* Any WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along with
+* this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*******************************************************************************/
+
+#include "RegularExpressionFilter.h"
+
+#include <algorithm>
+
+//___________________________________________________________________________
+RegularExpressionFilter::RegularExpressionFilter( const QRegularExpression& regexp )
+{
+
+    // options other than case sensitivity may change the meaning of the pattern
+    const auto pattern( regexp.pattern() );
+    if( pattern.isEmpty() || !regexp.isValid() ) return;
+    if( regexp.patternOptions() & ~QRegularExpression::PatternOptions( QRegularExpression::CaseInsensitiveOption ) ) return;
+    if( !_isSupported( pattern ) ) return;
+
+    if( regexp.patternOptions() & QRegularExpression::CaseInsensitiveOption )
+    { caseSensitivity_ = Qt::CaseInsensitive; }
+
+    // first characters
+    characters_.resize( 128 );
+    int position( 0 );
+    bool nullable( false );
+    const bool hasCharacters( _parseAlternatives( pattern, position, nullable ) && position == pattern.size() && !nullable );
+
+    // look for a unique first character
+    if( hasCharacters && !nonAscii_ && characters_.count( true ) == 1 )
+    {
+        for( int i = 0; i < characters_.size(); ++i )
+        {
+            if( !characters_.testBit( i ) ) continue;
+            character_ = QChar( i );
+            break;
+        }
+    }
+
+    // literals are preferred, unless reduced to a single character
+    literal_ = _requiredLiteral( pattern );
+    if( !literal_.isEmpty() && !( literal_.size() == 1 && !character_.isNull() ) ) type_ = Type::Literal;
+    else if( hasCharacters ) type_ = Type::FirstCharacter;
+
+    // case insensitive literal search might not fold letters the same way as the regular expression
+    exact_ = !literal_.isEmpty() && _isExact( pattern ) &&
+        ( caseSensitivity_ == Qt::CaseSensitive || std::none_of( literal_.begin(), literal_.end(), []( const QChar& character ) { return character.isLetter(); } ) );
+
+}
+
+//___________________________________________________________________________
+int RegularExpressionFilter::indexIn( const QString& text, int from, int to ) const
+{
+    const auto view( QStringView( text ).left( to ) );
+    switch( type_ )
+    {
+
+        case Type::Literal:
+        return view.indexOf( literal_, from, caseSensitivity_ ) >= 0 ? from:-1;
+
+        case Type::FirstCharacter:
+        {
+
+            // character search is vectorized
+            if( !character_.isNull() ) return view.indexOf( character_, from );
+
+            const auto data( view.data() );
+            for( int i = qMax( 0, from ); i < view.size(); ++i )
+            {
+                const auto character( data[i].unicode() );
+                if( character < 128 ? characters_.testBit( character ):nonAscii_ ) return i;
+            }
+
+            return -1;
+
+        }
+
+        default: return from;
+
+    }
+}
+
+//___________________________________________________________________________
+bool RegularExpressionFilter::_isSupported( const QString& pattern )
+{
+
+    for( int i = 0; i < pattern.size(); ++i )
+    {
+        const auto current( pattern.at(i) );
+        if( current == QLatin1Char( '\\' ) )
+        {
+
+            // escaped letters and digits must be known assertions, classes or control characters
+            if( ++i >= pattern.size() ) return false;
+            const auto next( pattern.at(i) );
+            if( !next.isLetterOrNumber() ) continue;
+            if( next.unicode() < 128 && QStringLiteral( "bBAzZdDwWsShHvVRtnrfae" ).contains( next ) ) continue;
+            return false;
+
+        } else if( current == QLatin1Char( '(' ) && i+1 < pattern.size() ) {
+
+            // only non capturing groups and lookarounds are supported
+            const auto next( pattern.at(i+1) );
+            if( next == QLatin1Char( '*' ) ) return false;
+            if( next != QLatin1Char( '?' ) ) continue;
+
+            if( i+2 >= pattern.size() ) return false;
+            const auto type( pattern.at(i+2) );
+            if( QStringLiteral( ":=!" ).contains( type ) ) continue;
+            if( type == QLatin1Char( '<' ) && i+3 < pattern.size() && QStringLiteral( "=!" ).contains( pattern.at(i+3) ) ) continue;
+            return false;
+
+        }
+    }
+
+    return true;
+
+}
+
+//___________________________________________________________________________
+QString RegularExpressionFilter::_requiredLiteral( const QString& pattern )
+{
+
+    QString best;
+    QString current;
+    int i( 0 );
+    while( i < pattern.size() )
+    {
+
+        const auto character( pattern.at(i) );
+
+        // top level alternatives have no common literal
+        if( character == QLatin1Char( '|' ) || character == QLatin1Char( ')' ) ) return QString();
+
+        QChar literal;
+        if( character == QLatin1Char( '\\' ) )
+        {
+
+            if( i+1 >= pattern.size() ) return QString();
+            const auto next( pattern.at(i+1) );
+            if( !next.isLetterOrNumber() ) literal = next;
+            else literal = _controlCharacter( next );
+            i += 2;
+
+        } else if( character == QLatin1Char( '[' ) || character == QLatin1Char( '(' ) ) {
+
+            if( !_skipAtom( pattern, i ) ) return QString();
+
+        } else if( QStringLiteral( ".^$" ).contains( character ) ) {
+
+            ++i;
+
+        } else {
+
+            // quantifier with no atom
+            bool optional( false );
+            if( _skipQuantifier( pattern, i, optional ) ) return QString();
+            literal = character;
+            ++i;
+
+        }
+
+        // a quantified atom ends current literal
+        bool optional( false );
+        const bool quantified( _skipQuantifier( pattern, i, optional ) );
+        if( !literal.isNull() && !optional ) current += literal;
+        if( literal.isNull() || quantified )
+        {
+            if( current.size() > best.size() ) best = current;
+            current.clear();
+        }
+
+    }
+
+    if( current.size() > best.size() ) best = current;
+    return best;
+
+}
+
+//___________________________________________________________________________
+bool RegularExpressionFilter::_isExact( const QString& pattern )
+{
+    for( int i = 0; i < pattern.size(); ++i )
+    {
+        const auto character( pattern.at(i) );
+        if( character == QLatin1Char( '\\' ) )
+        {
+
+            if( ++i >= pattern.size() ) return false;
+            const auto next( pattern.at(i) );
+            if( next.isLetterOrNumber() && _controlCharacter( next ).isNull() ) return false;
+
+        } else if( QStringLiteral( "^$.|?*+()[{" ).contains( character ) ) return false;
+    }
+
+    return true;
+}
+
+//___________________________________________________________________________
+bool RegularExpressionFilter::_skipAtom( const QString& pattern, int& i )
+{
+
+    const auto character( pattern.at(i) );
+    if( character == QLatin1Char( '\\' ) )
+    {
+
+        i += 2;
+        return i <= pattern.size();
+
+    } else if( character == QLatin1Char( '[' ) ) {
+
+        // first closing bracket, possibly after negation, is a literal
+        ++i;
+        if( i < pattern.size() && pattern.at(i) == QLatin1Char( '^' ) ) ++i;
+        if( i < pattern.size() && pattern.at(i) == QLatin1Char( ']' ) ) ++i;
+        while( i < pattern.size() )
+        {
+            const auto current( pattern.at(i) );
+            if( current == QLatin1Char( ']' ) )
+            {
+                ++i;
+                return true;
+            }
+
+            if( current == QLatin1Char( '\\' ) ) i += 2;
+            else if( current == QLatin1Char( '[' ) && i+1 < pattern.size() && pattern.at(i+1) == QLatin1Char( ':' ) )
+            {
+                const int end( pattern.indexOf( QLatin1String( ":]" ), i+2 ) );
+                if( end < 0 ) return false;
+                i = end+2;
+            } else ++i;
+        }
+
+        return false;
+
+    } else if( character == QLatin1Char( '(' ) ) {
+
+        ++i;
+        while( i < pattern.size() )
+        {
+            if( pattern.at(i) == QLatin1Char( ')' ) )
+            {
+                ++i;
+                return true;
+            }
+
+            if( !_skipAtom( pattern, i ) ) return false;
+        }
+
+        return false;
+
+    } else {
+
+        ++i;
+        return true;
+
+    }
+
+}
+
+//___________________________________________________________________________
+bool RegularExpressionFilter::_skipQuantifier( const QString& pattern, int& i, bool& optional )
+{
+
+    optional = false;
+    if( i >= pattern.size() ) return false;
+
+    const auto character( pattern.at(i) );
+    if( character == QLatin1Char( '*' ) || character == QLatin1Char( '?' ) )
+    {
+
+        optional = true;
+        ++i;
+
+    } else if( character == QLatin1Char( '+' ) ) {
+
+        ++i;
+
+    } else if( character == QLatin1Char( '{' ) ) {
+
+        // braces are literal unless they form a valid {n}, {n,} or {n,m} quantifier
+        int j( i+1 );
+        QString minimum;
+        while( j < pattern.size() && pattern.at(j).isDigit() ) minimum += pattern.at(j++);
+        if( minimum.isEmpty() || j >= pattern.size() ) return false;
+        if( pattern.at(j) == QLatin1Char( ',' ) )
+        {
+            ++j;
+            while( j < pattern.size() && pattern.at(j).isDigit() ) ++j;
+        }
+
+        if( j >= pattern.size() || pattern.at(j) != QLatin1Char( '}' ) ) return false;
+        optional = minimum.toInt() == 0;
+        i = j+1;
+
+    } else return false;
+
+    // lazy and possessive quantifiers
+    if( i < pattern.size() && ( pattern.at(i) == QLatin1Char( '?' ) || pattern.at(i) == QLatin1Char( '+' ) ) ) ++i;
+    return true;
+
+}
+
+//___________________________________________________________________________
+QChar RegularExpressionFilter::_controlCharacter( QChar character )
+{
+    switch( character.unicode() )
+    {
+        case 't': return QChar( 0x09 );
+        case 'n': return QChar( 0x0a );
+        case 'r': return QChar( 0x0d );
+        case 'f': return QChar( 0x0c );
+        case 'a': return QChar( 0x07 );
+        case 'e': return QChar( 0x1b );
+        default: return QChar();
+    }
+}
+
+//___________________________________________________________________________
+bool RegularExpressionFilter::_parseAlternatives( const QString& pattern, int& i, bool& nullable )
+{
+    nullable = false;
+    forever
+    {
+        bool sequenceNullable( false );
+        if( !_parseSequence( pattern, i, sequenceNullable ) ) return false;
+        nullable |= sequenceNullable;
+
+        if( i < pattern.size() && pattern.at(i) == QLatin1Char( '|' ) ) ++i;
+        else return true;
+    }
+}
+
+//___________________________________________________________________________
+bool RegularExpressionFilter::_parseSequence( const QString& pattern, int& i, bool& nullable )
+{
+
+    // first characters are those of the leading atoms,
+    // up to the first one that cannot match an empty string
+    nullable = true;
+    while( i < pattern.size() && pattern.at(i) != QLatin1Char( '|' ) && pattern.at(i) != QLatin1Char( ')' ) )
+    {
+        bool atomNullable( false );
+        if( !nullable ) { if( !_skipAtom( pattern, i ) ) return false; }
+        else if( !_parseAtom( pattern, i, atomNullable ) ) return false;
+
+        bool optional( false );
+        _skipQuantifier( pattern, i, optional );
+        if( nullable ) nullable = atomNullable || optional;
+    }
+
+    return true;
+
+}
+
+//___________________________________________________________________________
+bool RegularExpressionFilter::_parseAtom( const QString& pattern, int& i, bool& nullable )
+{
+
+    nullable = false;
+    const auto character( pattern.at(i) );
+    if( character == QLatin1Char( '\\' ) )
+    {
+
+        if( i+1 >= pattern.size() ) return false;
+        const auto next( pattern.at(i+1) );
+        i += 2;
+
+        // assertions
+        if( next.unicode() < 128 && QStringLiteral( "bBAzZ" ).contains( next ) )
+        {
+            nullable = true;
+            return true;
+        }
+
+        // control characters
+        const auto control( _controlCharacter( next ) );
+        if( !control.isNull() )
+        {
+            _addCharacter( control );
+            return true;
+        }
+
+        // classes
+        if( next.isLetterOrNumber() ) return _addClass( next );
+
+        // escaped literal
+        _addCharacter( next );
+        return true;
+
+    } else if( character == QLatin1Char( '^' ) || character == QLatin1Char( '$' ) ) {
+
+        nullable = true;
+        ++i;
+        return true;
+
+    } else if( character == QLatin1Char( '[' ) ) {
+
+        return _parseClass( pattern, i );
+
+    } else if( character == QLatin1Char( '(' ) ) {
+
+        // lookarounds do not consume characters
+        if( i+1 < pattern.size() && pattern.at(i+1) == QLatin1Char( '?' ) )
+        {
+            if( i+2 < pattern.size() && pattern.at(i+2) == QLatin1Char( ':' ) ) i += 3;
+            else {
+                nullable = true;
+                return _skipAtom( pattern, i );
+            }
+        } else ++i;
+
+        if( !_parseAlternatives( pattern, i, nullable ) ) return false;
+        if( i >= pattern.size() || pattern.at(i) != QLatin1Char( ')' ) ) return false;
+        ++i;
+        return true;
+
+    } else if( character == QLatin1Char( '.' ) ) {
+
+        return false;
+
+    } else {
+
+        // quantifier with no atom
+        bool optional( false );
+        int j( i );
+        if( _skipQuantifier( pattern, j, optional ) ) return false;
+
+        _addCharacter( character );
+        ++i;
+        return true;
+
+    }
+
+}
+
+//___________________________________________________________________________
+bool RegularExpressionFilter::_parseClass( const QString& pattern, int& i )
+{
+
+    // negated classes are not supported
+    ++i;
+    if( i >= pattern.size() || pattern.at(i) == QLatin1Char( '^' ) ) return false;
+
+    // first closing bracket is a literal
+    bool first( true );
+    while( i < pattern.size() )
+    {
+
+        auto character( pattern.at(i) );
+        if( character == QLatin1Char( ']' ) && !first )
+        {
+            ++i;
+            return true;
+        }
+
+        first = false;
+
+        // posix classes are not supported
+        if( character == QLatin1Char( '[' ) && i+1 < pattern.size() && pattern.at(i+1) == QLatin1Char( ':' ) ) return false;
+
+        if( character == QLatin1Char( '\\' ) )
+        {
+
+            if( i+1 >= pattern.size() ) return false;
+            const auto next( pattern.at(i+1) );
+            i += 2;
+
+            // backspace, inside classes
+            if( next == QLatin1Char( 'b' ) ) character = QChar( 0x08 );
+            else if( !_controlCharacter( next ).isNull() ) character = _controlCharacter( next );
+            else if( next.isLetterOrNumber() ) {
+
+                if( !_addClass( next ) ) return false;
+                continue;
+
+            } else character = next;
+
+        } else ++i;
+
+        // ranges
+        if( i+1 < pattern.size() && pattern.at(i) == QLatin1Char( '-' ) && pattern.at(i+1) != QLatin1Char( ']' ) )
+        {
+            const auto last( pattern.at(i+1) );
+            if( last == QLatin1Char( '\\' ) || last == QLatin1Char( '[' ) || last.unicode() < character.unicode() ) return false;
+            _addCharacters( character.unicode(), last.unicode() );
+            i += 2;
+
+        } else _addCharacter( character );
+
+    }
+
+    return false;
+
+}
+
+//___________________________________________________________________________
+bool RegularExpressionFilter::_addClass( QChar character )
+{
+    switch( character.unicode() )
+    {
+        case 'd':
+        _addCharacters( '0', '9' );
+        return true;
+
+        case 'w':
+        _addCharacters( 'a', 'z' );
+        _addCharacters( 'A', 'Z' );
+        _addCharacters( '0', '9' );
+        _addCharacter( QLatin1Char( '_' ) );
+        nonAscii_ = true;
+        return true;
+
+        case 's':
+        _addCharacters( 0x09, 0x0d );
+        _addCharacter( QLatin1Char( ' ' ) );
+        nonAscii_ = true;
+        return true;
+
+        case 'h':
+        _addCharacter( QChar( 0x09 ) );
+        _addCharacter( QLatin1Char( ' ' ) );
+        nonAscii_ = true;
+        return true;
+
+        default: return false;
+    }
+}
+
+//___________________________________________________________________________
+void RegularExpressionFilter::_addCharacters( ushort first, ushort last )
+{
+    for( ushort character = first; character <= qMin<ushort>( last, 127 ); ++character )
+    { _addCharacter( QChar( character ) ); }
+
+    if( last >= 128 ) nonAscii_ = true;
+}
+
+//___________________________________________________________________________
+void RegularExpressionFilter::_addCharacter( QChar character )
+{
+    if( character.unicode() >= 128 )
+    {
+        nonAscii_ = true;
+        return;
+    }
+
+    characters_.setBit( character.unicode() );
+
+    // case insensitive matching also applies to non ascii characters, such as the kelvin sign
+    if( caseSensitivity_ == Qt::CaseInsensitive && character.isLetter() )
+    {
+        characters_.setBit( character.toLower().unicode() );
+        characters_.setBit( character.toUpper().unicode() );
+        nonAscii_ = true;
+    }
+}
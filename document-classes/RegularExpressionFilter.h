@@ -0,0 +1,161 @@
+#ifndef RegularExpressionFilter_h
+#define RegularExpressionFilter_h
+
+/******************************************************************************
+*
+* Copyright (C) 2002 Hugo PEREIRA <mailto: hugo.pereira@free.fr>
+*
+* This is free software; you can redistribute it and/or modify it under the
+* terms of the GNU General Public License as published by the Free Software
+* Foundation; either version 2 of the License, or (at your option) any later
+* version.
+*
+* This software is distributed in the hope that it will be useful, but WITHOUT
+* Any WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along with
+* this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*******************************************************************************/
+
+
+#include <QBitArray>
+#include <QChar>
+#include <QRegularExpression>
+#include <QString>
+
+//* fast check for regular expression candidate matches
+/**
+the longest literal that must appear in any match, or the set of characters any match must start with,
+is extracted from the pattern when possible. When the text contains no such literal or character,
+the regular expression cannot match and needs not be run.
+Patterns using constructs that are not understood get no filter, and are always run
+*/
+class RegularExpressionFilter final
+{
+
+    public:
+
+    //* default constructor
+    explicit RegularExpressionFilter() = default;
+
+    //* constructor from regular expression
+    explicit RegularExpressionFilter( const QRegularExpression& );
+
+    //* filter type
+    enum class Type
+    {
+        None,
+        Literal,
+        FirstCharacter
+    };
+
+    //*@name accessors
+    //@{
+
+    //* type
+    Type type() const
+    { return type_; }
+
+    //* true if filter can reject text
+    bool isValid() const
+    { return type_ != Type::None; }
+
+    //* required literal
+    const QString& literal() const
+    { return literal_; }
+
+    //* true if regular expression matches exactly the literal, and nothing else
+    bool isExact() const
+    { return exact_; }
+
+    //* case sensitivity
+    Qt::CaseSensitivity caseSensitivity() const
+    { return caseSensitivity_; }
+
+    //* position from which the regular expression may match, or -1 if it cannot match
+    /**
+    for first characters, this is the position of the first candidate character.
+    For literals, this is the start position when the literal is found.
+    Text is considered to end at position to
+    */
+    int indexIn( const QString&, int from, int to ) const;
+
+    //@}
+
+    private:
+
+    //* true if all constructs used in pattern are understood
+    static bool _isSupported( const QString& );
+
+    //* longest literal that must appear in any match
+    static QString _requiredLiteral( const QString& );
+
+    //* true if pattern is made only of literal characters
+    static bool _isExact( const QString& );
+
+    //* skip atom starting at given position
+    /** returns false if pattern is malformed */
+    static bool _skipAtom( const QString&, int& );
+
+    //* skip quantifier at given position, if any
+    /** returns true if a quantifier is found. Optional is set to true if it allows zero repetition */
+    static bool _skipQuantifier( const QString&, int&, bool& optional );
+
+    //* control character matching escaped letter, if any
+    static QChar _controlCharacter( QChar );
+
+    //*@name first characters
+    //@{
+
+    //* parse alternatives up to closing parenthesis or end of pattern
+    /** returns false if first characters cannot be determined. Nullable is set to true if an empty match is possible */
+    bool _parseAlternatives( const QString&, int&, bool& nullable );
+
+    //* parse a sequence of atoms up to alternative separator, closing parenthesis or end of pattern
+    bool _parseSequence( const QString&, int&, bool& nullable );
+
+    //* parse atom
+    bool _parseAtom( const QString&, int&, bool& nullable );
+
+    //* parse character class
+    bool _parseClass( const QString&, int& );
+
+    //* add characters matching escaped class letter
+    /** returns false for unsupported classes */
+    bool _addClass( QChar );
+
+    //* add character range
+    void _addCharacters( ushort, ushort );
+
+    //* add character
+    void _addCharacter( QChar );
+
+    //@}
+
+    //* type
+    Type type_ = Type::None;
+
+    //* case sensitivity
+    Qt::CaseSensitivity caseSensitivity_ = Qt::CaseSensitive;
+
+    //* required literal
+    QString literal_;
+
+    //* true if regular expression matches exactly the literal
+    bool exact_ = false;
+
+    //* possible first characters, for the ascii range
+    QBitArray characters_;
+
+    //* true if any non ascii character can start a match
+    bool nonAscii_ = false;
+
+    //* only possible first character, if any
+    QChar character_;
+
+};
+
+#endif
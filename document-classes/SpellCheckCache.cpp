@@ -0,0 +1,91 @@
+/******************************************************************************
+*
+* Copyright (C) 2002 Hugo PEREIRA <mailto: hugo.pereira@free.fr>
+*
+* This is free software; you can redistribute it and/or modify it under the
+* terms of the GNU General Public License as published by the Free Software
+* Foundation; either version 2 of the License, or (at your option) any later
+* version.
+*
+* This software is distributed in the hope that it will be useful, but WITHOUT
+* Any WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along with
+* this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*******************************************************************************/
+
+#include "SpellCheckCache.h"
+
+#include <QCache>
+#include <QMutex>
+#include <QMutexLocker>
+
+namespace
+{
+    //* cache and associated mutex
+    class Data final
+    {
+        public:
+
+        //* constructor
+        explicit Data()
+        { cache_.setMaxCost( SpellCheckCache::maxSize ); }
+
+        //* mutex
+        QMutex mutex_;
+
+        //* misspelled words, with text size as cost
+        QCache<QString, SpellCheck::Word::Set> cache_;
+    };
+
+    //* process-wide instance
+    Data& data()
+    {
+        static Data data;
+        return data;
+    }
+}
+
+//___________________________________________________________________________
+bool SpellCheckCache::find( const QString& dictionary, const QString& filter, const QString& text, SpellCheck::Word::Set& words )
+{
+    auto& data( ::data() );
+    QMutexLocker locker( &data.mutex_ );
+    const auto cached( data.cache_.object( _key( dictionary, filter, text ) ) );
+    if( !cached ) return false;
+
+    words = *cached;
+    return true;
+}
+
+//___________________________________________________________________________
+void SpellCheckCache::insert( const QString& dictionary, const QString& filter, const QString& text, const SpellCheck::Word::Set& words )
+{
+    auto& data( ::data() );
+    QMutexLocker locker( &data.mutex_ );
+    data.cache_.insert( _key( dictionary, filter, text ), new SpellCheck::Word::Set( words ), text.size()+1 );
+}
+
+//___________________________________________________________________________
+void SpellCheckCache::clear()
+{
+    auto& data( ::data() );
+    QMutexLocker locker( &data.mutex_ );
+    data.cache_.clear();
+}
+
+//___________________________________________________________________________
+QString SpellCheckCache::_key( const QString& dictionary, const QString& filter, const QString& text )
+{
+    QString key;
+    key.reserve( dictionary.size() + filter.size() + text.size() + 2 );
+    key.append( dictionary );
+    key.append( QChar::Null );
+    key.append( filter );
+    key.append( QChar::Null );
+    key.append( text );
+    return key;
+}
@@ -0,0 +1,60 @@
+#ifndef SpellCheckCache_h
+#define SpellCheckCache_h
+
+/******************************************************************************
+*
+* Copyright (C) 2002 Hugo PEREIRA <mailto: hugo.pereira@free.fr>
+*
+* This is free software; you can redistribute it and/or modify it under the
+* terms of the GNU General Public License as published by the Free Software
+* Foundation; either version 2 of the License, or (at your option) any later
+* version.
+*
+* This software is distributed in the hope that it will be useful, but WITHOUT
+* Any WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along with
+* this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*******************************************************************************/
+
+#include "Word.h"
+
+#include <QString>
+
+//* misspelled words of already checked text, shared by all displays
+/**
+text is checked as a whole by the spell checker, which splits it into words according to the filter.
+Verdicts are therefore stored per checked text, together with the dictionary and filter used.
+Misspelled words are stored regardless of the words ignored in a given display, so that entries
+remain valid when words are ignored. The least recently used entries are discarded first.
+The cache can be accessed concurrently from the gui and the spell check threads
+*/
+class SpellCheckCache final
+{
+
+    public:
+
+    //* maximum total size of the cached text
+    static const int maxSize = 1<<22;
+
+    //* retrieve misspelled words for a given text. Returns false if not found
+    static bool find( const QString& dictionary, const QString& filter, const QString& text, SpellCheck::Word::Set& );
+
+    //* store misspelled words for a given text
+    static void insert( const QString& dictionary, const QString& filter, const QString& text, const SpellCheck::Word::Set& );
+
+    //* clear
+    /** must be called when verdicts change, for instance when words are added to the personal dictionary */
+    static void clear();
+
+    private:
+
+    //* key
+    static QString _key( const QString& dictionary, const QString& filter, const QString& text );
+
+};
+
+#endif
@@ -0,0 +1,141 @@
+/******************************************************************************
+*
+* Copyright (C) 2002 Hugo PEREIRA <mailto: hugo.pereira@free.fr>
+*
+* This is free software; you can redistribute it and/or modify it under the
+* terms of the GNU General Public License as published by the Free Software
+* Foundation; either version 2 of the License, or (at your option) any later
+* version.
+*
+* This software is distributed in the hope that it will be useful, but WITHOUT
+* Any WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along with
+* this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*******************************************************************************/
+
+#include "SpellCheckThread.h"
+#include "SpellCheckCache.h"
+#include "SpellParser.h"
+
+#include <QElapsedTimer>
+
+//_______________________________________________________________
+SpellCheckThread::SpellCheckThread( QObject* parent ):
+    QThread( parent ),
+    Counter( QStringLiteral("SpellCheckThread") )
+{}
+
+//_______________________________________________________________
+SpellCheckThread::~SpellCheckThread()
+{
+    {
+        QMutexLocker locker( &mutex_ );
+        aborted_ = true;
+        condition_.wakeAll();
+    }
+
+    wait();
+}
+
+//_______________________________________________________________
+void SpellCheckThread::addRequest( const Request& request )
+{
+    QMutexLocker locker( &mutex_ );
+    requests_.insert( request.block(), request );
+    condition_.wakeAll();
+}
+
+//_______________________________________________________________
+void SpellCheckThread::setVisibleBlocks( int first, int last )
+{
+    QMutexLocker locker( &mutex_ );
+    firstVisibleBlock_ = first;
+    lastVisibleBlock_ = last;
+}
+
+//_______________________________________________________________
+void SpellCheckThread::clear()
+{
+    QMutexLocker locker( &mutex_ );
+    requests_.clear();
+}
+
+//_______________________________________________________________
+bool SpellCheckThread::hasRequests()
+{
+    QMutexLocker locker( &mutex_ );
+    return !requests_.empty();
+}
+
+//_______________________________________________________________
+QList<SpellCheckThread::Request> SpellCheckThread::takeResults()
+{
+    QMutexLocker locker( &mutex_ );
+    QList<Request> out;
+    out.swap( results_ );
+    return out;
+}
+
+//_______________________________________________________________
+void SpellCheckThread::run()
+{
+
+    // spell checker is created in this thread, and kept for all requests
+    SpellCheck::SpellParser parser;
+    parser.setEnabled( true );
+
+    QElapsedTimer timer;
+    timer.start();
+
+    bool notify( false );
+    while( true )
+    {
+
+        Request request;
+
+        {
+            QMutexLocker locker( &mutex_ );
+
+            // notify when the queue is empty or after some time
+            if( notify && ( requests_.empty() || timer.elapsed() > maxBatchTime ) )
+            {
+                locker.unlock();
+                emit resultsAvailable();
+                notify = false;
+                timer.restart();
+                locker.relock();
+            }
+
+            while( requests_.empty() && !aborted_ )
+            { condition_.wait( &mutex_ ); }
+
+            if( aborted_ ) return;
+
+            // visible blocks go first
+            auto iter( requests_.lowerBound( firstVisibleBlock_ ) );
+            if( iter == requests_.end() || iter.key() > lastVisibleBlock_ ) iter = requests_.begin();
+            request = iter.value();
+            requests_.erase( iter );
+        }
+
+        // update spell checker
+        if( parser.interface().dictionary() != request.dictionary() ) parser.interface().setDictionary( request.dictionary() );
+        if( parser.interface().filter() != request.filter() ) parser.interface().setFilter( request.filter() );
+
+        // check and store
+        SpellCheckCache::insert( request.dictionary(), request.filter(), request.text(), parser.parse( request.text() ) );
+
+        {
+            QMutexLocker locker( &mutex_ );
+            results_.append( request );
+        }
+
+        notify = true;
+
+    }
+
+}
@@ -0,0 +1,156 @@
+#ifndef SpellCheckThread_h
+#define SpellCheckThread_h
+
+/******************************************************************************
+*
+* Copyright (C) 2002 Hugo PEREIRA <mailto: hugo.pereira@free.fr>
+*
+* This is free software; you can redistribute it and/or modify it under the
+* terms of the GNU General Public License as published by the Free Software
+* Foundation; either version 2 of the License, or (at your option) any later
+* version.
+*
+* This software is distributed in the hope that it will be useful, but WITHOUT
+* Any WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along with
+* this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*******************************************************************************/
+
+#include "Counter.h"
+#include "Word.h"
+
+#include <QList>
+#include <QMap>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <QWaitCondition>
+
+//* finds misspelled words of text blocks in a separate thread
+/**
+blocks are queued by block number. Visible blocks are processed first, then the others in document order.
+Misspelled words are stored in the shared SpellCheckCache, and the checked blocks are sent back to the main thread.
+The thread has its own spell checker, with no ignored words, and waits for new blocks when the queue is empty
+*/
+class SpellCheckThread: public QThread, private Base::Counter<SpellCheckThread>
+{
+
+    Q_OBJECT
+
+    public:
+
+    //* constructor
+    explicit SpellCheckThread( QObject* );
+
+    //* destructor
+    ~SpellCheckThread() override;
+
+    //* block to be checked
+    class Request
+    {
+
+        public:
+
+        //* constructor
+        explicit Request( int block = 0, const QString& dictionary = QString(), const QString& filter = QString(), const QString& text = QString() ):
+            block_( block ),
+            dictionary_( dictionary ),
+            filter_( filter ),
+            text_( text )
+        {}
+
+        //* block number
+        int block() const
+        { return block_; }
+
+        //* dictionary
+        const QString& dictionary() const
+        { return dictionary_; }
+
+        //* filter
+        const QString& filter() const
+        { return filter_; }
+
+        //* text
+        const QString& text() const
+        { return text_; }
+
+        private:
+
+        //* block number
+        int block_ = 0;
+
+        //* dictionary
+        QString dictionary_;
+
+        //* filter
+        QString filter_;
+
+        //* text
+        QString text_;
+
+    };
+
+    //*@name modifiers
+    //@{
+
+    //* queue block, replacing any pending request for the same block number
+    void addRequest( const Request& );
+
+    //* visible blocks
+    void setVisibleBlocks( int first, int last );
+
+    //* discard pending requests
+    void clear();
+
+    //* true if some requests are pending
+    bool hasRequests();
+
+    //* retrieve and clear checked blocks
+    QList<Request> takeResults();
+
+    //@}
+
+    Q_SIGNALS:
+
+    //* emitted when checked blocks are available
+    void resultsAvailable();
+
+    protected:
+
+    //* process requests
+    void run() override;
+
+    private:
+
+    //* maximum time spent between two notifications (ms)
+    static const int maxBatchTime = 50;
+
+    //* mutex
+    QMutex mutex_;
+
+    //* wait condition, for new requests
+    QWaitCondition condition_;
+
+    //* true when the thread must stop
+    bool aborted_ = false;
+
+    //* pending requests, by block number
+    QMap<int, Request> requests_;
+
+    //* checked blocks
+    QList<Request> results_;
+
+    //* first visible block
+    int firstVisibleBlock_ = 0;
+
+    //* last visible block
+    int lastVisibleBlock_ = -1;
+
+};
+
+#endif
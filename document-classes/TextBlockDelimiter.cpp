@@ -72,7 +72,14 @@ namespace TextBlock
     bool Delimiter::List::set( int i, const Delimiter& delimiter )
     {
         if( delimiters_.size() > i && delimiters_[i] == delimiter ) return false;
-        if( delimiters_.size() <= i ) { delimiters_.resize( i+1 ); }
+        if( delimiters_.size() <= i )
+        {
+            // empty delimiters past the end of the list need not be stored
+            static const Delimiter empty;
+            if( delimiter == empty ) return false;
+            delimiters_.resize( i+1 );
+        }
+
         delimiters_[i] = delimiter;
         return true;
     }
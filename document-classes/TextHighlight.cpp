@@ -23,8 +23,17 @@
 #include "HighlightPattern.h"
 #include "TextParenthesis.h"
 
+#if WITH_ASPELL
+#include "SpellCheckCache.h"
+#include "TextBlockRange.h"
+#endif
+
+#include <QBitArray>
 #include <QTextDocument>
+#include <QTimerEvent>
+#include <QVarLengthArray>
 
+#include <algorithm>
 #include <numeric>
 
 //_________________________________________________________
@@ -32,8 +41,161 @@ TextHighlight::TextHighlight( QTextDocument* document ):
     QSyntaxHighlighter( document ),
     Counter( QStringLiteral("TextHighlight") )
 {
-    textSelectionHighlightPattern_.setType( HighlightPattern::Type::KeywordPattern );
-    textSelectionHighlightPattern_.setParentId(-1);
+    setStyles( HighlightStyle::List() );
+
+    // background highlighting must be restarted on any change
+    connect( document, &QTextDocument::contentsChange, this, &TextHighlight::_contentsChanged );
+}
+
+//_______________________________________________________
+void TextHighlight::setPatterns( const HighlightPatternSet::Pointer& patterns )
+{
+    patterns_ = patterns ? patterns:HighlightPatternSet::emptySet();
+    windowCache_.clear();
+    _clearCheckpoints();
+
+    // patterns that already exceeded their budget are reported again
+    overBudgetSerial_ = -1;
+    overBudgetPatterns_ = QBitArray( patterns_->size()+1 );
+
+    if( thread_ )
+    {
+        _cancelThread();
+        thread_->wait();
+        thread_->setPatterns( patterns_ );
+        if( !pendingCursor_.isNull() )
+        {
+            restartNeeded_ = true;
+            timer_.start( 0, this );
+        }
+    }
+}
+
+//_______________________________________________________
+void TextHighlight::setAsynchronous( bool value )
+{
+    Debug::Throw() << "TextHighlight::setAsynchronous - value: " << value << Qt::endl;
+    if( asynchronous_ == value ) return;
+    asynchronous_ = value;
+
+    if( asynchronous_ )
+    {
+
+        if( !thread_ )
+        {
+            thread_ = new TextHighlightThread( this );
+            connect( thread_, &TextHighlightThread::resultsAvailable, this, &TextHighlight::_processResults, Qt::QueuedConnection );
+            connect( thread_, &QThread::finished, this, &TextHighlight::_threadFinished, Qt::QueuedConnection );
+        }
+
+        thread_->setPatterns( patterns_ );
+
+    } else _highlightPending();
+
+}
+
+//_______________________________________________________
+void TextHighlight::setVisibleBlocks( int first, int last )
+{
+    firstVisibleBlock_ = first;
+    lastVisibleBlock_ = last;
+    if( thread_ && thread_->isRunning() ) _updateVisibleBlocks();
+    _highlightVisibleBlocks();
+
+    #if WITH_ASPELL
+    if( spellCheckThread_ ) spellCheckThread_->setVisibleBlocks( first, last );
+    #endif
+}
+
+//_______________________________________________________
+void TextHighlight::rehighlightInBackground()
+{
+    Debug::Throw( QStringLiteral("TextHighlight::rehighlightInBackground.\n") );
+
+    // lazy documents only highlight visible blocks anyway
+    bool background( asynchronous_ && thread_ && !isLazy() && isHighlightEnabled() && !patterns_->empty() );
+    #if WITH_ASPELL
+    background &= !spellParser_.isEnabled();
+    #endif
+
+    if( !background )
+    {
+        rehighlight();
+        return;
+    }
+
+    // all blocks are pending
+    _cancelThread();
+    _clearPending();
+    _setPending( document()->firstBlock() );
+    _setPending( document()->lastBlock() );
+}
+
+//_______________________________________________________
+bool TextHighlight::isLazy() const
+{ return isLazy( document()->characterCount() ); }
+
+//_______________________________________________________
+bool TextHighlight::isLazy( int characterCount ) const
+{
+    #if WITH_ASPELL
+    if( spellParser_.isEnabled() ) return false;
+    #endif
+
+    return lazySize_ > 0 && characterCount > lazySize_;
+}
+
+//_________________________________________________________
+bool TextHighlight::cachedLocations( HighlightCache::Locations& locations ) const
+{
+
+    if( !isHighlightEnabled() || patterns_->empty() ) return false;
+
+    #if WITH_ASPELL
+    if( spellParser_.isEnabled() ) return false;
+    #endif
+
+    // blocks waiting for background highlighting
+    if( !( pendingCursor_.isNull() && longLineCursors_.empty() ) ) return false;
+
+    HighlightCache::Locations out;
+    out.reserve( document()->blockCount() );
+    int activeId( -1 );
+    for( auto block = document()->begin(); block.isValid(); block = block.next() )
+    {
+        const auto data = dynamic_cast<HighlightBlockData*>( block.userData() );
+        if( data )
+        {
+
+            if( data->hasFlag( TextBlock::BlockModified ) ) return false;
+            out.append( data->compactLocations() );
+
+        } else {
+
+            // blocks with no locations keep no data. Their active ids are those of the block states
+            PatternLocationSet empty;
+            empty.activeId() = std::make_pair( activeId, block.userState() );
+            out.append( PatternLocationSet::Compact( empty ) );
+
+        }
+
+        activeId = block.userState();
+    }
+
+    locations.swap( out );
+    return true;
+
+}
+
+//_________________________________________________________
+void TextHighlight::setCacheKey( const QByteArray& key )
+{
+
+    // lazy documents only highlight blocks close to the visible ones, and are never stored
+    cacheKey_ = isLazy() ? QByteArray():key;
+    if( cacheKey_.isEmpty() || !isHighlightEnabled() || patterns_->empty() ) return;
+    _storeCache();
+
 }
 
 //_______________________________________________________
@@ -43,63 +205,161 @@ void TextHighlight::setParenthesis( const TextParenthesis::List& parenthesis )
     parenthesis_ = parenthesis;
 }
 
+//_______________________________________________________
+void TextHighlight::setBlockDelimiters( const BlockDelimiter::List& delimiters )
+{
+    blockDelimiters_ = delimiters;
+    windowCache_.clear();
+
+    // combine delimiters in a single regular expression, so that each block is scanned once
+    /*
+    at a given position, only the first matching delimiter is counted.
+    Delimiters with back references cannot be combined, since capture groups are renumbered
+    */
+    blockDelimitersRegexp_ = QRegularExpression();
+    blockDelimiterGroups_.clear();
+    if( blockDelimiters_.size() < 2 ) return;
+
+    static const QRegularExpression backReference( QStringLiteral( "\\\\([1-9]|g|k)" ) );
+    QStringList patterns;
+    int group = 1;
+    for( const auto& delimiter:blockDelimiters_ )
+    {
+        const auto& regexp( delimiter.regexp() );
+        if( !regexp.isValid() || regexp.pattern().contains( backReference ) )
+        {
+            blockDelimiterGroups_.clear();
+            return;
+        }
+
+        patterns.append( QStringLiteral( "(" ) + regexp.pattern() + QStringLiteral( ")" ) );
+        blockDelimiterGroups_.append( group );
+        group += regexp.captureCount() + 1;
+    }
+
+    blockDelimitersRegexp_.setPattern( patterns.join( QLatin1Char( '|' ) ) );
+    if( !blockDelimitersRegexp_.isValid() ) blockDelimiterGroups_.clear();
+}
+
 //_________________________________________________________
 void TextHighlight::highlightBlock( const QString& text )
 {
+    // profiling
+    QElapsedTimer profileTimer;
+    const bool profile( HighlightProfiler::isEnabled() );
+    if( profile ) profileTimer.start();
+
     // check if syntax highlighting is enabled
-    bool highlightEnabled( isHighlightEnabled()  && !patterns_.empty() );
+    // it is replaced by automatic spellcheck, if any
+    bool highlightEnabled( isHighlightEnabled()  && !patterns_->empty() );
     #if WITH_ASPELL
-    highlightEnabled |= spellParser_.isEnabled();
+    highlightEnabled &= !spellParser_.isEnabled();
     #endif
 
     // retrieve activeId from last block state
     int activeId( previousBlockState() );
     PatternLocationSet locations;
 
+    // long blocks are highlighted by windows, together with their delimiters
+    const bool longLine( text.size() > longLineSize );
+    TextBlock::Delimiter::List delimiters;
+
+    // in lazy mode, only blocks close to the visible ones are highlighted
+    // their active id is computed from the closest checkpoint, since previous blocks might not be up to date
+    const bool lazy( highlightEnabled && isLazy() );
+    const bool lazyVisible( lazy && _isLazyVisible( currentBlock() ) );
+    if( lazyVisible ) activeId = _lazyActiveId( currentBlock() );
+
     // try retrieve HighlightBlockData
     bool needUpdate( true );
 
     // try retrieve block data
     auto data = dynamic_cast<HighlightBlockData*>( currentBlockUserData() );
+    bool created( false );
 
     if( data )
     {
         // see if block needs update
         needUpdate =
             data->hasFlag( TextBlock::BlockModified ) ||
-            (highlightEnabled && (locations = data->locations()).activeId().first != activeId );
+            (highlightEnabled && data->activeId().first != activeId );
+        if( highlightEnabled && !needUpdate ) locations = data->locations();
     } else {
         // try retrieve data from parent type
         auto textData = static_cast<TextBlockData*>( currentBlockUserData() );
         data = textData ? new HighlightBlockData( textData ) : new HighlightBlockData;
+        created = !textData;
         setCurrentBlockUserData( data );
     }
 
+    // use cached locations, when loading a document
+    PatternLocationSet::Compact cachedLocations;
+    const bool cached( highlightEnabled && needUpdate && _cachedLocationSet( text, activeId, cachedLocations ) );
+    if( cached )
+    {
+        locations = PatternLocationSet( cachedLocations );
+        data->setFlag( TextBlock::BlockModified, false );
+        data->setLocations( cachedLocations );
+        if( !data->hasFlag( TextBlock::BlockCollapsed ) ) setCurrentBlockState( locations.activeId().second );
+        else setCurrentBlockState( 0 );
+    }
+
+    // leave highlighting to the thread, or to when the block becomes visible
+    /* current locations and block state are kept until new locations are available */
+    if( highlightEnabled && needUpdate && !cached && ( ( lazy && !lazyVisible ) || ( !longLine && _isDeferred() ) ) )
+    {
+        if( lazy ) data->setFlag( TextBlock::BlockModified, true );
+        else if( !speculative_ ) _setPending( currentBlock() );
+        locations = data->locations();
+        needUpdate = false;
+    }
+
     // highlight patterns
-    if( highlightEnabled && needUpdate )
+    if( highlightEnabled && needUpdate && !cached )
     {
 
         // get new set of highlight locations
-        locations = _highlightLocationSet( text, activeId );
+        bool complete( true );
+        if( longLine ) complete = _longLineLocationSet( text, activeId, locations, delimiters );
+        else locations = _highlightLocationSet( text, activeId );
 
         // update data modification state and highlight pattern locations
-        data->setFlag( TextBlock::BlockModified, false );
+        // incomplete blocks are kept modified, so that they are processed again
+        data->setFlag( TextBlock::BlockModified, !complete );
         data->setLocations( locations );
 
         // store active id
-        /* this is disabled when current block is collapsed */
-        if( !data->hasFlag( TextBlock::BlockCollapsed ) ) setCurrentBlockState( locations.activeId().second );
+        /*
+        this is disabled when current block is collapsed.
+        For incomplete blocks, the current state is kept until the end of the block is reached
+        */
+        if( !complete ) _setLongLinePending( currentBlock() );
+        else if( !data->hasFlag( TextBlock::BlockCollapsed ) ) setCurrentBlockState( locations.activeId().second );
         else setCurrentBlockState( 0 );
 
+        _checkBudget();
+
+    }
+
+    // store checkpoint and block state, used for next block
+    if( lazyVisible )
+    {
+        const int blockNumber( currentBlock().blockNumber() );
+        _storeCheckpoint( blockNumber, activeId );
+        _setLastLazyBlock( blockNumber, currentBlockState() );
     }
 
     // block delimiters parsing
     if( isBlockDelimitersEnabled() && needUpdate )
     {
-        if( std::accumulate( blockDelimiters_.begin(), blockDelimiters_.end(), false,
-            [this, data, &text]( bool value, const BlockDelimiter& delimiter )
-            { return _updateDelimiter( data, delimiter, text ) ? true:std::move(value); } ) )
-        { emit needSegmentUpdate(); }
+        bool changed( false );
+        if( longLine && highlightEnabled && !cached )
+        {
+            for( const auto& delimiter:blockDelimiters_ )
+            { changed |= data->setDelimiters( delimiter.id(), delimiters.get( delimiter.id() ) ); }
+        } else changed = _updateDelimiters( data, text );
+
+        if( changed ) emit needSegmentUpdate();
     }
 
     // before try applying the found locations see if automatic spellcheck is on
@@ -110,18 +370,12 @@ void TextHighlight::highlightBlock( const QString& text )
         // clear locations
         locations = _spellCheckLocationSet( text, data );
         data->setLocations( PatternLocationSet() );
+        data->setFlag( TextBlock::BlockModified, false );
         setCurrentBlockState( -1 );
 
     }
     #endif
 
-    // text selection
-    if( textSelectionHighlightPattern_.isValid() )
-    {
-        bool active = false;
-        textSelectionHighlightPattern_.processText( locations, text, active );
-    }
-
     // apply new location set
     if( !locations.empty() ) _applyPatterns( locations );
 
@@ -133,6 +387,11 @@ void TextHighlight::highlightBlock( const QString& text )
         setFormat( data->parenthesis(), data->parenthesisLength(), parenthesisHighlightFormat_ );
     }
 
+    // blocks with nothing to store keep no data. They are considered modified when highlighted again
+    /* in lazy mode, data is needed to tell which blocks are up to date */
+    if( created && !lazy && data->isEmpty() ) setCurrentBlockUserData( nullptr );
+
+    if( profile ) HighlightProfiler::blockCounters().add( profileTimer.nsecsElapsed(), locations.size() );
     return;
 
 }
@@ -146,58 +405,45 @@ PatternLocationSet TextHighlight::locationSet( const QString& text, int activeId
     else
     #endif
 
-    if( isHighlightEnabled()  && !patterns_.empty() ) return _highlightLocationSet( text, activeId );
+    if( isHighlightEnabled()  && !patterns_->empty() ) return _highlightLocationSet( text, activeId );
     else return PatternLocationSet();
 
 }
 
 //_________________________________________________________
-void TextHighlight::setTextSelectionHighlightColor( const QColor& color )
+void TextHighlight::setStyles( const HighlightStyle::List& styles )
 {
-    HighlightStyle style( QStringLiteral("textselection_style") );
-    style.setBackgroundColor( color );
-    textSelectionHighlightPattern_.setStyle( style );
+    styles_ = styles;
+
+    // spellcheck style is stored after the document class styles
+    #if WITH_ASPELL
+    spellPattern_.setStyleIndex( styles_.size() );
+    #endif
+
+    _updateFormats();
 }
 
 //_________________________________________________________
-bool TextHighlight::updateTextSelection(const TextSelection& textSelection )
+const HighlightStyle& TextHighlight::style( const PatternLocation& location ) const
 {
+    const int index( location.styleIndex() );
+    if( index < styles_.size() ) return styles_[index];
+    #if WITH_ASPELL
+    else if( index == spellPattern_.styleIndex() ) return spellPattern_.style();
+    #endif
 
-    const bool changed =
-        (textSelection_.hasFlag( TextSelection::HighlightAll ) != textSelection.hasFlag( TextSelection::HighlightAll ) ) ||
-        (textSelection_.hasFlag( TextSelection::CaseSensitive ) != textSelection.hasFlag( TextSelection::CaseSensitive ) ) ||
-        (textSelection_.hasFlag( TextSelection::EntireWord ) != textSelection.hasFlag( TextSelection::EntireWord ) ) ||
-        (textSelection_.hasFlag( TextSelection::RegExp ) != textSelection.hasFlag( TextSelection::RegExp ) ) ||
-        (textSelection_.text() != textSelection.text());
-
-    // check if changed
-    if( !changed ) return false;
-
-    // if highlight all has not changed and is false, also do nothing
-    if( !( textSelection_.hasFlag( TextSelection::HighlightAll ) || textSelection.hasFlag( TextSelection::HighlightAll ) ) )
-    {
-        textSelection_ = textSelection;
-        return false;
-    }
-
-    // update stored selection
-    textSelection_ = textSelection;
+    static const HighlightStyle defaultStyle;
+    return defaultStyle;
+}
 
-    // update text selection highlight pattern
-    if( !textSelection.hasFlag( TextSelection::HighlightAll ) || textSelection.text().isEmpty() )
-    {
-        textSelectionHighlightPattern_.setKeyword( QRegularExpression() );
-    } else {
-        textSelectionHighlightPattern_.setFlag( HighlightPattern::CaseInsensitive, !textSelection.hasFlag( TextSelection::CaseSensitive ) );
-        if( textSelection.hasFlag( TextSelection::RegExp ) ) textSelectionHighlightPattern_.setKeyword( textSelection.text() );
-        else {
-            auto escaped = QRegularExpression::escape( textSelection.text() );
-            if( textSelection.hasFlag( TextSelection::EntireWord )) escaped = QStringLiteral( "\\b" ) + escaped + QStringLiteral( "\\b" );
-            textSelectionHighlightPattern_.setKeyword( escaped );
-        }
-    }
+//_________________________________________________________
+const QTextCharFormat& TextHighlight::locationFormat( const PatternLocation& location ) const
+{
+    const int index( location.styleIndex() );
+    if( index < formats_.size() ) return formats_[index];
 
-    return true;
+    static const QTextCharFormat defaultFormat;
+    return defaultFormat;
 }
 
 #if WITH_ASPELL
@@ -208,13 +454,69 @@ void TextHighlight::updateSpellPattern()
     style.setFontFormat( spellParser_.fontFormat() );
     style.setColor( spellParser_.color() );
     spellPattern_.setStyle( std::move( style ) );
+    _updateFormats();
+}
+
+//_________________________________________________________
+void TextHighlight::_addSpellCheckRequest( const QString& text )
+{
+    if( !spellCheckThread_ )
+    {
+        spellCheckThread_ = new SpellCheckThread( this );
+        connect( spellCheckThread_, &SpellCheckThread::resultsAvailable, this, &TextHighlight::_processSpellCheckResults, Qt::QueuedConnection );
+        spellCheckThread_->setVisibleBlocks( firstVisibleBlock_, lastVisibleBlock_ );
+        spellCheckThread_->start( QThread::LowPriority );
+    }
+
+    const auto& interface( spellParser_.interface() );
+    spellCheckThread_->addRequest( SpellCheckThread::Request( currentBlock().blockNumber(), interface.dictionary(), interface.filter(), text ) );
+}
+
+//_________________________________________________________
+void TextHighlight::_processSpellCheckResults()
+{
+    const auto results( spellCheckThread_->takeResults() );
+    if( !spellParser_.isEnabled() )
+    {
+        spellCheckThread_->clear();
+        spellCheckResultsLost_ = false;
+        return;
+    }
+
+    // misspelled words are now cached. Highlight the checked blocks again
+    for( const auto& result:results )
+    {
+        const auto block( document()->findBlockByNumber( result.block() ) );
+        const auto data( dynamic_cast<HighlightBlockData*>( block.userData() ) );
+        if( !( data && data->hasFlag( TextBlock::SpellCheckPending ) ) ) continue;
+        if( block.text() == result.text() ) rehighlightBlock( block );
+        else spellCheckResultsLost_ = true;
+    }
+
+    // blocks moved by edits while being checked are looked for once all requests are processed
+    if( spellCheckResultsLost_ && !spellCheckThread_->hasRequests() )
+    {
+        spellCheckResultsLost_ = false;
+        for( const auto& block:TextBlockRange( document() ) )
+        {
+            const auto data( dynamic_cast<HighlightBlockData*>( block.userData() ) );
+            if( data && data->hasFlag( TextBlock::SpellCheckPending ) ) rehighlightBlock( block );
+        }
+    }
+
 }
 #endif
 
 //_________________________________________________________
-PatternLocationSet TextHighlight::_highlightLocationSet( const QString& text, int activeId ) const
+PatternLocationSet TextHighlight::highlightLocationSet( const HighlightPatternSet& patternSet, const QString& text, int from, int to, int activeId )
 {
 
+    const auto& patterns( patternSet.patterns() );
+    const auto& program( patternSet.program() );
+
+    // discarded locations are counted when profiling
+    const bool profile( HighlightProfiler::isEnabled() );
+
     // location list
     PatternLocationSet locations;
     locations.activeId().first = activeId;
@@ -225,49 +527,47 @@ PatternLocationSet TextHighlight::_highlightLocationSet( const QString& text, in
     {
 
         // look for matching pattern in list
-        auto patternIter = std::find_if( patterns_.begin(), patterns_.end(), HighlightPattern::SameIdFTor( activeId ) );
-        Q_ASSERT( patternIter != patterns_.end() );
+        const auto patternPointer = patternSet.find( activeId );
+        Q_ASSERT( patternPointer );
 
-        const HighlightPattern &pattern( *patternIter );
+        const HighlightPattern &pattern( *patternPointer );
         bool active=true;
-        pattern.processText( locations, text, active );
+        pattern.processText( locations, text, from, to, active );
 
         // if not active, break the loop to process the other patterns
         if( active )
         {
 
             // if still active. look for child patterns
-            for( const auto& childPattern:pattern.children() )
-            { childPattern.processText( locations, text, active );}
+            for( const auto& childId:pattern.children() )
+            { patternSet.find( childId )->processText( locations, text, from, to, active );}
 
             // remove patterns that overlap with others
-            auto iter = locations.begin();
-            auto prev = locations.begin();
-
+            // kept locations are moved in place to the front of the set, which is truncated afterwards
             // first pattern is skipped because it must be the parent
-            // so that prev is incremented once and current is incremented twice
-            if( iter != locations.end() ) ++iter;
-            if( iter != locations.end() ) ++iter;
-            if( prev != locations.end() ) ++prev;
-            while( iter != locations.end() )
+            // so that prev starts at one and current starts at two
+            if( locations.size() <= 2 ) return locations;
+
+            int prev = 1;
+            int kept = 2;
+            for( int index = 2; index < locations.size(); ++index )
             {
 
-                // no need to compare prev and iter parent Ids because they are known to be the
+                // no need to compare prev and current parent Ids because they are known to be the
                 // active parrent
-                if( iter->position() < prev->position()+(int)prev->length() )
+                const PatternLocation current( locations[index] );
+                if( current.position() < locations[prev].position()+locations[prev].length() )
                 {
+                    if( profile ) patternSet.find( current.id() )->addOverlap();
+                    continue;
+                }
 
-                    // current iterator overlaps with prev
-                    auto current = iter++;
-                    locations.erase( current );
-
-                } else {
-
-                    prev = iter++;
+                locations[kept] = current;
+                prev = kept++;
 
-                }
             }
 
+            locations.resize( kept );
             return locations;
         }
 
@@ -275,88 +575,104 @@ PatternLocationSet TextHighlight::_highlightLocationSet( const QString& text, in
 
     // no active pattern
     // normal processing
-    int activePatterns(0);
-    for( const auto& pattern:patterns_ )
+    // active patterns are stored in a bit array indexed by pattern id
+    QBitArray activePatterns( patterns.size()+1 );
+
+    // process merged keyword patterns in a single pass, when possible
+    QVector<PatternLocation> programLocations;
+    // merged patterns are processed one by one when profiling, so that time is reported per pattern
+    const bool useProgram( !HighlightProfiler::isEnabled() && program.isValid() && program.processText( programLocations, text, from, to ) );
+    if( !useProgram ) programLocations.clear();
+
+    for( const auto& pattern:patterns )
     {
 
         // do not reprocess active pattern (if any)
         // sincee it was already done
         if( (int)pattern.id() == activeId ) continue;
 
+        // do not reprocess merged patterns
+        if( useProgram && program.contains( pattern.id() ) ) continue;
+
         // process pattern, store activity
         bool active = false;
 
         // here one could check if the pattern appears at least once (by checking return value of processText
         // and loop over children here (in place of main loop) if yes.
-        pattern.processText( locations, text, active );
-        if( active ) activePatterns |= pattern.id();
+        pattern.processText( locations, text, from, to, active );
+        if( active ) activePatterns.setBit( pattern.id() );
 
     }
 
+    // insert locations from merged patterns
+    // for identical positions, the location from the pattern that comes first in the list
+    // must be kept, as if patterns were processed one by one, after the active pattern
+    const int size( locations.size() );
+    for( const auto& location:programLocations )
+    { locations.append( location ); }
+
+    locations.merge( size, [activeId]( const PatternLocation& kept, const PatternLocation& location )
+    { return kept.id() != activeId && location.id() < kept.id(); } );
+
     // check number of recorded locations
     if( locations.empty() ) return locations;
 
-    // remove locations that are front and have parents
-    while( !locations.empty() && locations.begin()->parentId() ) locations.erase(locations.begin());
-
     // remove patterns that overlap with others
-    auto iter = locations.begin();
-    auto prev = locations.begin();
-    auto parent = locations.begin();
-
-    if( iter != locations.end() ) ++iter;
-    while( iter != locations.end() )
+    // kept locations are moved in place to the front of the set, which is truncated afterwards
+    // locations that are front and have parents are skipped
+    int first = 0;
+    while( first < locations.size() && locations[first].parentId() ) ++first;
+
+    int kept = 0;
+    int prev = 0;
+    int parent = 0;
+    for( int index = first; index < locations.size(); ++index )
     {
 
-        // check if patterns overlap
-        if( iter->position() < prev->position()+(int)prev->length() )
+        const PatternLocation current( locations[index] );
+        if( index == first )
         {
 
-            // check if iterator has parent that match
-            if( iter->parentId() == prev->id() )
+            // first location is always kept
+            locations[kept++] = current;
+
+        } else if( current.position() < locations[prev].position()+locations[prev].length() ) {
+
+            // patterns overlap. Check if current has parent that match
+            if( current.parentId() == locations[prev].id() )
             {
 
-                prev = iter;
-                ++iter;
+                locations[kept] = current;
+                prev = kept++;
 
             } else {
 
-                // remove current pattern
-                auto current = iter;
-                ++iter;
-
                 // remove pattern from active list
-                activePatterns &= (~current->id());
-                locations.erase( current );
+                activePatterns.clearBit( current.id() );
+                if( profile ) patternSet.find( current.id() )->addOverlap();
+
             }
 
-        } else if( iter->position() < parent->position()+(int)parent->length()  ) {
+        } else if( current.position() < locations[parent].position()+locations[parent].length() ) {
 
             // no overlap with prev. Check against parent
-            if( iter->parentId() == parent->id() )
+            if( current.parentId() == locations[parent].id() )
             {
-                prev = iter;
-                ++iter;
-            } else {
-
-                auto current = iter;
-                ++iter;
-
-                // remove pattern from active list
-                locations.erase( current );
-
-            }
+                locations[kept] = current;
+                prev = kept++;
+            } else if( profile ) patternSet.find( current.id() )->addOverlap();
 
         } else {
 
-            // no increment. Advance one.
-            parent = iter;
-            prev = iter;
-            ++iter;
+            // no overlap. Current becomes parent
+            locations[kept] = current;
+            parent = prev = kept++;
 
         }
     }
 
+    locations.resize( kept );
+
     // check activity
     // one loop over the remaining locations
     // stop at the first one that is found in the list of possibly active
@@ -364,7 +680,7 @@ PatternLocationSet TextHighlight::_highlightLocationSet( const QString& text, in
         locations.activeId().second = 0;
         auto iter = std::find_if( locations.begin(), locations.end(),
             [&activePatterns]( const PatternLocation& location )
-            { return activePatterns & location.id(); } );
+            { return activePatterns.testBit( location.id() ); } );
 
         if( iter != locations.end() ) locations.activeId().second = iter->id();
     }
@@ -379,13 +695,40 @@ PatternLocationSet TextHighlight::_spellCheckLocationSet( const QString& text, H
 
     #if WITH_ASPELL
 
-    // insert highlight
-    const SpellCheck::Word::Set& words( spellParser_.parse( text ) );
+    // retrieve misspelled words from cache
+    auto& interface( spellParser_.interface() );
+    SpellCheck::Word::Set words;
+    if( SpellCheckCache::find( interface.dictionary(), interface.filter(), text, words ) )
+    {
+
+        if( data ) data->setFlag( TextBlock::SpellCheckPending, false );
+
+    } else if( data && text.size() < SpellCheckCache::maxSize ) {
+
+        // check current block in the thread
+        // meanwhile, keep the previous misspelled words that are unchanged
+        _addSpellCheckRequest( text );
+        data->setFlag( TextBlock::SpellCheckPending, true );
+        for( const auto& word:data->misspelledWords() )
+        {
+            if( word.position() + word.length() <= text.size() &&
+                QStringView( text ).mid( word.position(), word.length() ) == QStringView( word.get() ) )
+            { words.insert( word ); }
+        }
+
+    } else words = spellParser_.parse( text );
+
+    // insert highlight, skipping ignored words
+    SpellCheck::Word::Set misspelledWords;
     for( const auto& word:words )
-    { locations.insert( PatternLocation( spellPattern_, word.position(), word.length() ) ); }
+    {
+        if( interface.isWordIgnored( word.get() ) ) continue;
+        locations.insert( PatternLocation( spellPattern_, word.position(), word.length() ) );
+        misspelledWords.insert( word );
+    }
 
     // store misspelled words
-    if( data ) data->setMisspelledWords( words );
+    if( data ) data->setMisspelledWords( misspelledWords );
     #else
     Q_UNUSED(text);
     Q_UNUSED(data);
@@ -394,45 +737,647 @@ PatternLocationSet TextHighlight::_spellCheckLocationSet( const QString& text, H
     return locations;
 }
 
+//_________________________________________________________
+void TextHighlight::_checkBudget()
+{
+    const int serial( HighlightPattern::overBudgetSerial() );
+    if( serial == overBudgetSerial_ ) return;
+    overBudgetSerial_ = serial;
+
+    for( const auto& pattern:patterns_->patterns() )
+    {
+        const int id( pattern.id() );
+        if( id >= overBudgetPatterns_.size() || overBudgetPatterns_.testBit( id ) || !pattern.overBudgetCount() ) continue;
+        overBudgetPatterns_.setBit( id );
+        emit patternOverBudget( pattern.name() );
+    }
+}
+
+//_________________________________________________________
+bool TextHighlight::_longLineLocationSet( const QString& text, int activeId, PatternLocationSet& locations, TextBlock::Delimiter::List& delimiters )
+{
+
+    QElapsedTimer timer;
+    timer.start();
+
+    locations.clear();
+    locations.activeId().first = activeId;
+    locations.activeId().second = activeId;
+
+    bool computed( false );
+    int start( 0 );
+    while( start < text.size() )
+    {
+
+        // the last window extends to the end of the text
+        // others end at the first candidate boundary that is not inside a location,
+        // or at the maximum window length
+        const bool last( text.size() - start <= HighlightWindowCache::maxLength );
+        const int end( last ? text.size():start + HighlightWindowCache::maxLength );
+        int candidate( last ? -1:HighlightWindowCache::candidate( text, start + HighlightWindowCache::minLength, end ) );
+
+        const HighlightWindowCache::Window* current( nullptr );
+        HighlightWindowCache::Window window;
+        while( !current )
+        {
+
+            // look for window in cache
+            const int segmentLength( ( candidate < 0 ? end:qMin( candidate + HighlightWindowCache::margin, text.size() ) ) - start );
+            const auto key( HighlightWindowCache::key( text, start, segmentLength ) );
+            if( ( current = windowCache_.find( key, segmentLength, activeId ) ) ) break;
+
+            // check time budget. At least one window is highlighted per call
+            if( computed && timer.hasExpired( maxSynchronousTime ) ) return false;
+
+            // patterns are matched on the text itself, so that the text preceding the window is seen
+            // locations are stored relative to the window start
+            window.segmentLength_ = segmentLength;
+            window.firstActiveId_ = activeId;
+            window.locations_ = highlightLocationSet( *patterns_, text, start, start + segmentLength, activeId );
+            for( int index = 0; index < window.locations_.size(); ++index )
+            { window.locations_[index].setPosition( window.locations_[index].position() - start ); }
+
+            if( candidate < 0 )
+            {
+
+                window.length_ = segmentLength;
+                window.activeId_ = window.locations_.activeId().second;
+
+            } else if( !HighlightWindowCache::isCovered( window.locations_, candidate - start ) ) {
+
+                // no pattern can be active past a boundary that is not inside a location
+                // locations located after the boundary are dropped
+                window.length_ = candidate - start;
+                window.activeId_ = 0;
+
+                const auto iter( std::find_if( window.locations_.begin(), window.locations_.end(),
+                    [&window]( const PatternLocation& location ) { return location.position() >= window.length_; } ) );
+                window.locations_.resize( std::distance( window.locations_.begin(), iter ) );
+
+            } else {
+
+                // try next candidate
+                candidate = HighlightWindowCache::candidate( text, candidate+1, end );
+                continue;
+
+            }
+
+            // block delimiters
+            if( isBlockDelimitersEnabled() )
+            { window.delimiters_ = _countDelimiters( text.mid( start, window.length_ ), window.locations_ ); }
+
+            windowCache_.insert( key, window );
+            current = &window;
+            computed = true;
+
+        }
+
+        // append window locations and delimiters
+        for( auto location:current->locations_ )
+        {
+            location.setPosition( location.position() + start );
+            locations.insert( location );
+        }
+
+        delimiters += current->delimiters_;
+        activeId = current->activeId_;
+        start += current->length_;
+
+    }
+
+    locations.activeId().second = activeId;
+    return true;
+
+}
+
+//_________________________________________________________
+void TextHighlight::_setLongLinePending( const QTextBlock& block )
+{
+    if( std::none_of( longLineCursors_.begin(), longLineCursors_.end(),
+        [&block]( const QTextCursor& cursor ) { return cursor.block() == block; } ) )
+    { longLineCursors_.append( QTextCursor( block ) ); }
+
+    timer_.start( 0, this );
+}
+
+//_________________________________________________________
+void TextHighlight::_updateFormats()
+{
+    formats_.clear();
+    formats_.reserve( styles_.size()+1 );
+    for( const auto& style:styles_ )
+    { formats_.append( style.format() ); }
+
+    #if WITH_ASPELL
+    formats_.append( spellPattern_.style().format() );
+    #endif
+}
+
 //_________________________________________________________
 void TextHighlight::_applyPatterns( const PatternLocationSet& locations )
 {
-    // initialize style
-    int patternId(-1);
-    QTextCharFormat currentFormat;
+    // end position and background of the locations that have one
+    /*
+    locations being sorted by position, a location that has no background
+    gets the one of the last location that covers its start, if any
+    */
+    QVarLengthArray<std::pair<int, QBrush>, 4> backgrounds;
     for( const auto& location:locations )
     {
-        if( patternId != location.id() )
+        const int position( location.position() );
+        while( !backgrounds.empty() && backgrounds.last().first <= position )
+        { backgrounds.removeLast(); }
+
+        const auto& format( locationFormat( location ) );
+        if( format.hasProperty( QTextFormat::BackgroundBrush ) )
+        {
+
+            backgrounds.append( std::make_pair( position + location.length(), format.background() ) );
+            setFormat( position, location.length(), format );
+
+        } else if( !backgrounds.empty() ) {
+
+            QTextCharFormat copy( format );
+            copy.setBackground( backgrounds.last().second );
+            backgrounds.append( std::make_pair( position + location.length(), backgrounds.last().second ) );
+            setFormat( position, location.length(), copy );
+
+        } else setFormat( position, location.length(), format );
+
+    }
+}
+
+//_________________________________________________________
+bool TextHighlight::_updateDelimiters( HighlightBlockData* data, const QString& text ) const
+{
+    const auto delimiters( _countDelimiters( text, data->locations() ) );
+    return std::accumulate( blockDelimiters_.begin(), blockDelimiters_.end(), false,
+        [data, &delimiters]( bool value, const BlockDelimiter& delimiter )
+        { return data->setDelimiters( delimiter.id(), delimiters.get( delimiter.id() ) ) ? true:std::move(value); } );
+}
+
+//_________________________________________________________
+TextBlock::Delimiter::List TextHighlight::_countDelimiters( const QString& text, const PatternLocationSet& locations ) const
+{
+
+    TextBlock::Delimiter::List out;
+    if( blockDelimiterGroups_.empty() )
+    {
+
+        // scan text once per delimiter
+        for( const auto& delimiter:blockDelimiters_ )
         {
-            patternId = location.id();
-            currentFormat = location.format();
+            TextBlock::Delimiter counter;
+            int index = 0;
+            auto iter( delimiter.regexp().globalMatch( text ) );
+            while( iter.hasNext() )
+            {
+                const auto match( iter.next() );
+                const auto position = match.capturedStart();
+                _countDelimiter( counter, delimiter, QStringView( text ).mid( position, match.capturedLength() ), locations.isCommented( position, index ) );
+            }
+
+            out.set( delimiter.id(), counter );
+        }
+
+    } else {
+
+        // scan text once for all delimiters
+        // the matching delimiter is the one whose capture group is set
+        QVector<TextBlock::Delimiter> counters( blockDelimiters_.size() );
+        int index = 0;
+        auto iter( blockDelimitersRegexp_.globalMatch( text ) );
+        while( iter.hasNext() )
+        {
+            const auto match( iter.next() );
+            const auto position = match.capturedStart();
+
+            int delimiter = 0;
+            while( delimiter+1 < blockDelimiterGroups_.size() && match.capturedStart( blockDelimiterGroups_[delimiter] ) < 0 )
+            { ++delimiter; }
+
+            _countDelimiter( counters[delimiter], blockDelimiters_[delimiter], QStringView( text ).mid( position, match.capturedLength() ), locations.isCommented( position, index ) );
         }
 
-        QTextCharFormat format( currentFormat );
-        const QTextCharFormat old( TextHighlight::format( location.position() ) );
-        if( old.hasProperty( QTextFormat::BackgroundBrush ) && !format.hasProperty( QTextFormat::BackgroundBrush ) )
-        { format.setBackground( old.background() ); }
+        for( int delimiter = 0; delimiter < blockDelimiters_.size(); ++delimiter )
+        { out.set( blockDelimiters_[delimiter].id(), counters[delimiter] ); }
+
+    }
+
+    return out;
+}
+
+//_________________________________________________________
+void TextHighlight::_countDelimiter( TextBlock::Delimiter& counter, const BlockDelimiter& delimiter, QStringView matched, bool isCommented )
+{
+    if( matched.contains( delimiter.first() ) ) counter.increment( isCommented );
+    else if( matched.contains( delimiter.second() ) ) counter.decrement( isCommented );
+}
+
+//_________________________________________________________
+void TextHighlight::timerEvent( QTimerEvent* event )
+{
+    if( event->timerId() == timer_.timerId() )
+    {
+        timer_.stop();
+        elapsedTimer_.invalidate();
+
+        // restart after document changes is delayed
+        if( restartNeeded_ && !restartTimer_.isActive() ) _startThread();
+
+        // resume highlighting of long blocks
+        QList<QTextCursor> cursors;
+        std::swap( cursors, longLineCursors_ );
+        for( const auto& cursor:cursors )
+        { if( !cursor.isNull() ) rehighlightBlock( cursor.block() ); }
+
+        // store locations once all blocks are highlighted
+        if( pendingCursor_.isNull() && longLineCursors_.empty() ) _storeCache();
+
+    } else if( event->timerId() == restartTimer_.timerId() ) {
+
+        restartTimer_.stop();
+        if( restartNeeded_ ) _startThread();
+
+    } else QSyntaxHighlighter::timerEvent( event );
+}
 
-        setFormat( location.position(), location.length(), format );
+//_________________________________________________________
+bool TextHighlight::_isDeferred()
+{
+    if( !( asynchronous_ && thread_ ) || isLazy() ) return false;
+
+    #if WITH_ASPELL
+    if( spellParser_.isEnabled() ) return false;
+    #endif
+
+    if( speculative_ ) return true;
+
+    // synchronous highlighting time is reset at the next event loop pass
+    if( !elapsedTimer_.isValid() )
+    {
+        elapsedTimer_.start();
+        timer_.start( 0, this );
     }
+
+    return elapsedTimer_.elapsed() > maxSynchronousTime;
+}
+
+//_________________________________________________________
+void TextHighlight::_contentsChanged( int position )
+{
+    // checkpoints located after the modified block are outdated
+    if( checkpoints_.size() > 1 || lastLazyBlock_ >= 0 )
+    { _clearCheckpoints( document()->findBlock( position ).blockNumber() ); }
+
+    if( pendingCursor_.isNull() ) return;
+
+    // block numbers and text sent to the thread are outdated
+    // the thread is restarted once the document is left unchanged for a while
+    _cancelThread();
+    restartNeeded_ = true;
+    restartTimer_.start( restartDelay, this );
 }
 
 //_________________________________________________________
-bool TextHighlight::_updateDelimiter( HighlightBlockData* data, const BlockDelimiter& delimiter, const QString& text ) const
+void TextHighlight::_processResults()
 {
+    const auto results( thread_->takeResults() );
+    if( !isHighlightEnabled() )
+    {
+        _cancelThread();
+        _clearPending();
+        return;
+    }
 
-    TextBlock::Delimiter counter;
-    auto iter( delimiter.regexp().globalMatch( text ) );
-    while( iter.hasNext() )
+    bool segmentsChanged( false );
+    for( const auto& result:results )
     {
-        const auto match( iter.next() );
-        const auto position = match.capturedStart();
-        const auto length = match.capturedLength();
-        const bool isCommented( data->locations().isCommented( position ) );
-        const auto matchedString( text.mid( position, length ) );
-        if( matchedString.contains( delimiter.first() ) ) counter.increment( isCommented );
-        else if( matchedString.contains( delimiter.second() ) ) counter.decrement( isCommented );
+        // discard outdated results
+        if( result.serial() != serial_ || pendingCursor_.isNull() ) continue;
+
+        if( result.isSpeculative() ) _applySpeculativeResult( result );
+        else if( _applyResult( result ) ) segmentsChanged = true;
     }
 
-    return data->setDelimiters( delimiter.id(), counter );
+    if( segmentsChanged ) emit needSegmentUpdate();
+    _checkBudget();
+
+    // store locations once all blocks are highlighted
+    if( pendingCursor_.isNull() ) _storeCache();
 }
+
+//_________________________________________________________
+void TextHighlight::_setPending( const QTextBlock& block )
+{
+    // pending blocks are tracked using cursors, so that they follow document changes
+    const int position( block.position() );
+    if( pendingCursor_.isNull() || position < pendingCursor_.block().position() ) pendingCursor_ = QTextCursor( block );
+    if( pendingEndCursor_.isNull() || position > pendingEndCursor_.block().position() ) pendingEndCursor_ = QTextCursor( block );
+
+    restartNeeded_ = true;
+    timer_.start( 0, this );
+}
+
+//_________________________________________________________
+void TextHighlight::_clearPending()
+{
+    pendingCursor_ = QTextCursor();
+    pendingEndCursor_ = QTextCursor();
+    restartNeeded_ = false;
+}
+
+//_________________________________________________________
+void TextHighlight::_highlightPending()
+{
+    if( pendingCursor_.isNull() ) return;
+    Debug::Throw( QStringLiteral("TextHighlight::_highlightPending.\n") );
+
+    _cancelThread();
+
+    auto block( pendingCursor_.block() );
+    const auto last( pendingEndCursor_.block() );
+    _clearPending();
+
+    // block state changes are propagated to the next blocks by the base class
+    for( ; block.isValid() && block.position() <= last.position(); block = block.next() )
+    { rehighlightBlock( block ); }
+}
+
+//_________________________________________________________
+void TextHighlight::_cancelThread()
+{
+    if( !thread_ ) return;
+    ++serial_;
+    thread_->cancel();
+}
+
+//_________________________________________________________
+void TextHighlight::_startThread()
+{
+    restartNeeded_ = false;
+    if( !( thread_ && asynchronous_ ) || pendingCursor_.isNull() ) return;
+
+    const auto block( pendingCursor_.block() );
+    if( !block.isValid() )
+    {
+        _clearPending();
+        return;
+    }
+
+    // do not block until the cancelled thread returns. It is restarted once finished
+    _cancelThread();
+    if( thread_->isRunning() )
+    {
+        restartNeeded_ = true;
+        return;
+    }
+
+    Debug::Throw() << "TextHighlight::_startThread - block: " << block.blockNumber() << Qt::endl;
+
+    // only text from the first pending block is needed
+    QTextCursor cursor( block );
+    cursor.movePosition( QTextCursor::End, QTextCursor::KeepAnchor );
+
+    // the state of the previous block is used as a starting point
+    const auto previous( block.previous() );
+    thread_->wait();
+    thread_->setText( serial_, cursor.selectedText(), block.blockNumber(), previous.isValid() ? previous.userState():-1 );
+    _updateVisibleBlocks();
+    thread_->start( QThread::LowPriority );
+}
+
+//_________________________________________________________
+void TextHighlight::_threadFinished()
+{ if( restartNeeded_ && !restartTimer_.isActive() ) _startThread(); }
+
+//_________________________________________________________
+void TextHighlight::_updateVisibleBlocks()
+{
+    if( firstVisibleBlock_ < 0 ) return;
+
+    // guess active id from the current state of the previous block
+    const auto previous( document()->findBlockByNumber( firstVisibleBlock_ ).previous() );
+    thread_->setVisibleBlocks( firstVisibleBlock_, lastVisibleBlock_, previous.isValid() ? qMax( 0, previous.userState() ):-1 );
+}
+
+//_________________________________________________________
+void TextHighlight::_applySpeculativeResult( const TextHighlightThread::Result& result )
+{
+
+    const int firstPending( pendingCursor_.block().blockNumber() );
+    auto block( document()->findBlockByNumber( result.firstBlock() ) );
+
+    speculative_ = true;
+    for( const auto& locations:result.locations() )
+    {
+        if( !block.isValid() ) break;
+
+        // blocks that are not pending are already up to date
+        if( block.blockNumber() >= firstPending )
+        {
+            auto data = dynamic_cast<HighlightBlockData*>( block.userData() );
+            if( !data )
+            {
+                auto textData = static_cast<TextBlockData*>( block.userData() );
+                data = textData ? new HighlightBlockData( textData ) : new HighlightBlockData;
+                block.setUserData( data );
+            }
+
+            // keep block modified so that locations get recalculated
+            data->setFlag( TextBlock::BlockModified, true );
+            data->setLocations( locations );
+            rehighlightBlock( block );
+        }
+
+        block = block.next();
+    }
+
+    speculative_ = false;
+
+}
+
+//_________________________________________________________
+bool TextHighlight::_applyResult( const TextHighlightThread::Result& result )
+{
+
+    bool segmentsChanged( false );
+    const int lastPending( pendingEndCursor_.block().blockNumber() );
+    auto block( document()->findBlockByNumber( result.firstBlock() ) );
+    for( const auto& locations:result.locations() )
+    {
+        if( !block.isValid() ) break;
+
+        // check that the thread and the document agree on the block starting state
+        /* this is not the case for blocks that follow a collapsed block. Restart from there */
+        const auto previous( block.previous() );
+        if( locations.activeId().first != ( previous.isValid() ? previous.userState():-1 ) )
+        {
+            pendingCursor_ = QTextCursor( block );
+            _startThread();
+            return segmentsChanged;
+        }
+
+        // past the last pending block, stop as soon as locations are unchanged
+        if( !_applyLocations( block, locations, segmentsChanged ) && block.blockNumber() >= lastPending )
+        {
+            _cancelThread();
+            _clearPending();
+            return segmentsChanged;
+        }
+
+        block = block.next();
+    }
+
+    if( block.isValid() ) pendingCursor_ = QTextCursor( block );
+    else _clearPending();
+
+    return segmentsChanged;
+
+}
+
+//_________________________________________________________
+bool TextHighlight::_applyLocations( QTextBlock block, const PatternLocationSet& locations, bool& segmentsChanged )
+{
+
+    auto data = dynamic_cast<HighlightBlockData*>( block.userData() );
+    bool created( false );
+    if( !data )
+    {
+        auto textData = static_cast<TextBlockData*>( block.userData() );
+        data = textData ? new HighlightBlockData( textData ) : new HighlightBlockData;
+        created = !textData;
+        block.setUserData( data );
+    }
+
+    // store active id
+    /* this is disabled when current block is collapsed */
+    const int state( data->hasFlag( TextBlock::BlockCollapsed ) ? 0:locations.activeId().second );
+
+    // check if changed
+    if( !data->hasFlag( TextBlock::BlockModified ) && block.userState() == state && data->locations().isSame( locations ) )
+    { return false; }
+
+    data->setFlag( TextBlock::BlockModified, false );
+    data->setLocations( locations );
+    block.setUserState( state );
+
+    if( isBlockDelimitersEnabled() && _updateDelimiters( data, block.text() ) )
+    { segmentsChanged = true; }
+
+    // block state being already up to date, this only applies formats to the block
+    rehighlightBlock( block );
+
+    // blocks with nothing to store keep no data
+    if( created && data->isEmpty() ) block.setUserData( nullptr );
+    return true;
+
+}
+
+//_________________________________________________________
+bool TextHighlight::_isLazyVisible( const QTextBlock& block ) const
+{
+    const int blockNumber( block.blockNumber() );
+    if( firstVisibleBlock_ < 0 ) return blockNumber <= 2*lazyMargin;
+    else return blockNumber >= firstVisibleBlock_ - lazyMargin && blockNumber <= lastVisibleBlock_ + lazyMargin;
+}
+
+//_________________________________________________________
+void TextHighlight::_highlightVisibleBlocks()
+{
+    if( !( isHighlightEnabled() && !patterns_->empty() && isLazy() ) ) return;
+
+    for( auto block = document()->findBlockByNumber( qMax( 0, firstVisibleBlock_ - lazyMargin ) ); block.isValid() && _isLazyVisible( block ); block = block.next() )
+    {
+        // blocks whose locations are up to date need not be processed again
+        const int activeId( _lazyActiveId( block ) );
+        auto data = dynamic_cast<HighlightBlockData*>( block.userData() );
+        if( data && !data->hasFlag( TextBlock::BlockModified ) && data->activeId().first == activeId )
+        {
+
+            _storeCheckpoint( block.blockNumber(), activeId );
+            _setLastLazyBlock( block.blockNumber(), block.userState() );
+
+        } else rehighlightBlock( block );
+    }
+}
+
+//_________________________________________________________
+int TextHighlight::_lazyActiveId( const QTextBlock& block )
+{
+    const int blockNumber( block.blockNumber() );
+    if( blockNumber == 0 ) return -1;
+    if( blockNumber == lastLazyBlock_+1 ) return lastLazyActiveId_;
+
+    // start from closest checkpoint
+    if( checkpoints_.empty() ) checkpoints_.append( -1 );
+    int currentNumber( qMin( blockNumber/checkpointInterval, checkpoints_.size()-1 )*checkpointInterval );
+    int activeId( checkpoints_[currentNumber/checkpointInterval] );
+
+    // process blocks up to the requested one, storing new checkpoints on the way
+    // locations of blocks that are up to date are not recalculated
+    for( auto current = document()->findBlockByNumber( currentNumber ); current.isValid() && currentNumber < blockNumber; current = current.next(), ++currentNumber )
+    {
+        _storeCheckpoint( currentNumber, activeId );
+        auto data = dynamic_cast<HighlightBlockData*>( current.userData() );
+        if( data && data->hasFlag( TextBlock::BlockCollapsed ) ) activeId = 0;
+        else if( data && !data->hasFlag( TextBlock::BlockModified ) && data->activeId().first == activeId ) activeId = data->activeId().second;
+        else activeId = _highlightLocationSet( current.text(), activeId ).activeId().second;
+    }
+
+    return activeId;
+}
+
+//_________________________________________________________
+void TextHighlight::_storeCheckpoint( int blockNumber, int activeId )
+{
+    if( blockNumber % checkpointInterval == 0 && blockNumber/checkpointInterval == checkpoints_.size() )
+    { checkpoints_.append( activeId ); }
+}
+
+//_________________________________________________________
+void TextHighlight::_setLastLazyBlock( int blockNumber, int activeId )
+{
+    lastLazyBlock_ = blockNumber;
+    lastLazyActiveId_ = activeId;
+}
+
+//_________________________________________________________
+void TextHighlight::_clearCheckpoints( int blockNumber )
+{
+    // a checkpoint only depends on the blocks located before
+    const int size( blockNumber/checkpointInterval + 1 );
+    if( size < checkpoints_.size() ) checkpoints_.resize( size );
+    lastLazyBlock_ = -1;
+}
+
+//_________________________________________________________
+bool TextHighlight::_cachedLocationSet( const QString& text, int activeId, PatternLocationSet::Compact& locations ) const
+{
+    if( cachedLocations_.empty() ) return false;
+
+    const int blockNumber( currentBlock().blockNumber() );
+    if( blockNumber >= cachedLocations_.size() ) return false;
+
+    // check active id, and that locations fit in the block
+    const auto& cached( cachedLocations_.at( blockNumber ) );
+    if( cached.activeId().first != activeId ) return false;
+    if( std::any_of( cached.begin(), cached.end(), [&text]( const PatternLocation& location ) { return location.position() + location.length() > text.size(); } ) )
+    { return false; }
+
+    locations = cached;
+    return true;
+}
+
+//_________________________________________________________
+void TextHighlight::_storeCache()
+{
+    if( cacheKey_.isEmpty() || isLazy() || document()->isModified() ) return;
+
+    HighlightCache::Locations locations;
+    if( !cachedLocations( locations ) ) return;
+
+    HighlightCache::insert( cacheKey_, locations );
+    cacheKey_.clear();
+}
+
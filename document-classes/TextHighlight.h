@@ -24,15 +24,28 @@
 #include "Counter.h"
 #include "Debug.h"
 #include "HighlightBlockFlags.h"
+#include "HighlightCache.h"
 #include "HighlightPattern.h"
+#include "HighlightPatternSet.h"
+#include "HighlightProfiler.h"
+#include "HighlightWindowCache.h"
+#include "TextHighlightThread.h"
 #include "TextParenthesis.h"
-#include "TextSelection.h"
 
 #if WITH_ASPELL
+#include "SpellCheckThread.h"
 #include "SpellParser.h"
 #endif
 
+#include <QBasicTimer>
+#include <QBitArray>
+#include <QElapsedTimer>
+#include <QList>
+#include <QRegularExpression>
+#include <QStringView>
 #include <QSyntaxHighlighter>
+#include <QTextCursor>
+#include <QVector>
 
 class HighlightPattern;
 class HighlightBlockData;
@@ -53,8 +66,22 @@ class TextHighlight: public QSyntaxHighlighter, private Base::Counter<TextHighli
     void highlightBlock( const QString& ) override;
 
     //* retrieve highlight location for given text
+    /** this does not depend on background nor lazy highlighting, and is used for printing and exporting */
     PatternLocationSet locationSet( const QString& text, int activeId );
 
+    //* retrieve highlight location for given text and patterns
+    /** this only uses its arguments, and can be called from a separate thread */
+    static PatternLocationSet highlightLocationSet( const HighlightPatternSet& patternSet, const QString& text, int activeId )
+    { return highlightLocationSet( patternSet, text, 0, text.size(), activeId ); }
+
+    //* retrieve highlight location for given text range [from, to) and patterns
+    /**
+    text preceding the range is visible to anchors, word boundaries and lookbehinds,
+    while text is considered to end at the end of the range.
+    Location positions are relative to the text
+    */
+    static PatternLocationSet highlightLocationSet( const HighlightPatternSet&, const QString&, int from, int to, int activeId );
+
     //*@name highlight patterns
     //@{
 
@@ -72,11 +99,97 @@ class TextHighlight: public QSyntaxHighlighter, private Base::Counter<TextHighli
 
     //* patterns
     const HighlightPattern::List& patterns() const
-    { return patterns_; }
+    { return patterns_->patterns(); }
 
     //* patterns
-    void setPatterns( const HighlightPattern::List& patterns )
-    { patterns_ = patterns; }
+    /** they are shared with the document class rather than copied */
+    void setPatterns( const HighlightPatternSet::Pointer& );
+
+    //* style table
+    const HighlightStyle::List& styles() const
+    { return styles_; }
+
+    //* style table
+    void setStyles( const HighlightStyle::List& );
+
+    //* style matching location
+    const HighlightStyle& style( const PatternLocation& ) const;
+
+    //* character format matching location
+    const QTextCharFormat& locationFormat( const PatternLocation& ) const;
+
+    //@}
+
+    //*@name background highlighting
+    //@{
+
+    //* true if highlighting is computed in a separate thread
+    bool isAsynchronous() const
+    { return asynchronous_; }
+
+    //* highlighting computed in a separate thread
+    /**
+    blocks are highlighted synchronously until a time budget is exhausted.
+    Remaining blocks keep their current formats until locations are computed by the thread
+    */
+    void setAsynchronous( bool );
+
+    //* visible blocks
+    /**
+    they are processed first when highlighting in background,
+    and are the only ones highlighted for documents larger than the lazy size
+    */
+    void setVisibleBlocks( int first, int last );
+
+    //* rehighlight all blocks in background
+    /**
+    blocks must have been marked modified. They keep their current formats until
+    locations are computed by the thread, visible ones first.
+    Falls back to synchronous rehighlight when there is no thread
+    */
+    void rehighlightInBackground();
+
+    //@}
+
+    //*@name lazy highlighting
+    //@{
+
+    //* document size (in characters) above which only blocks close to the visible ones are highlighted
+    /** 0 means disabled */
+    void setLazySize( int value )
+    { lazySize_ = value; }
+
+    //* true if only blocks close to the visible ones are highlighted
+    bool isLazy() const;
+
+    //* true if only blocks close to the visible ones would be highlighted, for a given document size
+    bool isLazy( int characterCount ) const;
+
+    //@}
+
+    //*@name highlight cache
+    //@{
+
+    //* locations used for the next highlighted blocks, by block number
+    /**
+    they are set from the highlight cache while loading a document, and cleared afterwards.
+    Cached locations are used for a block only if its incoming active id matches and they
+    fit in the block text. Other blocks are highlighted normally
+    */
+    void setCachedLocations( const HighlightCache::Locations& locations )
+    { cachedLocations_ = locations; }
+
+    //* locations of all blocks, to be stored in the highlight cache
+    /** returns false if some blocks are not up to date */
+    bool cachedLocations( HighlightCache::Locations& ) const;
+
+    //* key under which locations are stored in the highlight cache
+    /**
+    locations are stored as soon as all blocks are highlighted, provided that the document is not modified.
+    Lazy documents, which only highlight blocks close to the visible ones, are not stored.
+    An empty key cancels the pending store
+    */
+    void setCacheKey( const QByteArray& );
 
     //@}
 
@@ -124,12 +237,12 @@ class TextHighlight: public QSyntaxHighlighter, private Base::Counter<TextHighli
     {
         if( blockDelimitersEnabled_ == state ) return false;
         blockDelimitersEnabled_ = state;
+        windowCache_.clear();
         return true;
     }
 
     //* block delimiters
-    void setBlockDelimiters( const BlockDelimiter::List& delimiters )
-    { blockDelimiters_ = delimiters; }
+    void setBlockDelimiters( const BlockDelimiter::List& );
 
     //* block delimiters
     const BlockDelimiter::List& blockDelimiters() const
@@ -137,25 +250,12 @@ class TextHighlight: public QSyntaxHighlighter, private Base::Counter<TextHighli
 
     //@}
 
-    //*@name text selection highlight
-    //@{
-    //* highghlight color
-    void setTextSelectionHighlightColor( const QColor& );
-    
-    //* highghlight color
-    QColor textSelectionHighlightColor() const
-    { return textSelectionHighlightPattern_.style().backgroundColor(); }
-    
-    //* find text selection
-    bool updateTextSelection( const TextSelection& );
-    
-    //@}
-    
     //* patterns
     void clear()
     {
         Debug::Throw( QStringLiteral("TextHighlight::clear.\n") );
-        patterns_.clear();
+        setPatterns( HighlightPatternSet::emptySet() );
+        setStyles( HighlightStyle::List() );
     }
 
     #if WITH_ASPELL
@@ -182,37 +282,244 @@ class TextHighlight: public QSyntaxHighlighter, private Base::Counter<TextHighli
     //* emitted when block delimiters have changed
     void needSegmentUpdate();
 
+    //* emitted the first time a pattern exceeds its budget
+    /** the pattern is then ignored in the blocks for which this happens */
+    void patternOverBudget( const QString& );
+
+    protected:
+
+    //* timer event
+    void timerEvent( QTimerEvent* ) override;
+
     private:
 
     //*@name syntax highlighting
     //@{
 
     //* retrieve highlight location for given text
-    PatternLocationSet _highlightLocationSet( const QString&, int activeId ) const;
-
-    //* retrieve highlight location for given text
+    PatternLocationSet _highlightLocationSet( const QString& text, int activeId ) const
+    { return highlightLocationSet( *patterns_, text, activeId ); }
+
+    //* retrieve misspelled words location for given text
+    /**
+    when data is set, text is the current block. Its misspelled words are then taken from the cache,
+    or computed in the spell check thread, and stored in data
+    */
     PatternLocationSet _spellCheckLocationSet( const QString& text, HighlightBlockData* data = 0 );
     
+    //* update character formats from styles
+    void _updateFormats();
+
     //* apply locations to current block
     void _applyPatterns( const PatternLocationSet& locations );
 
-    //* calculate delimiter object
-    bool _updateDelimiter( HighlightBlockData*, const BlockDelimiter&, const QString& ) const;
+    //* calculate delimiter objects. Returns true if changed
+    bool _updateDelimiters( HighlightBlockData*, const QString& ) const;
+
+    //* count all block delimiters in text, using locations to find commented ones
+    TextBlock::Delimiter::List _countDelimiters( const QString&, const PatternLocationSet& ) const;
+
+    //* update delimiter counter from matched text
+    static void _countDelimiter( TextBlock::Delimiter&, const BlockDelimiter&, QStringView, bool isCommented );
+
+    //* emit signal for patterns that exceeded their budget since last check
+    void _checkBudget();
 
     //* true if highlight is enabled
     bool highlightEnabled_ = false;
 
-    //* list of highlight patterns
-    HighlightPattern::List patterns_;
+    //* highlight patterns
+    HighlightPatternSet::Pointer patterns_ = HighlightPatternSet::emptySet();
 
-    //* text selection
-    TextSelection textSelection_;
-    
-    //* text selection highlight pattern
-    HighlightPattern textSelectionHighlightPattern_;
+    //* style table
+    HighlightStyle::List styles_;
+
+    //* character formats, one per style
+    /** spellcheck format is stored after the style table */
+    QVector<QTextCharFormat> formats_;
+
+    //* over budget serial, at last check
+    int overBudgetSerial_ = -1;
+
+    //* patterns already reported as over budget, indexed by id
+    QBitArray overBudgetPatterns_;
         
     //@}
 
+    //*@name background highlighting
+    //@{
+
+    //* true if current block highlighting must be left to the thread
+    bool _isDeferred();
+
+    //* document contents changed
+    void _contentsChanged( int );
+
+    //* apply results from background highlighting
+    void _processResults();
+
+    //* mark block as waiting for background highlighting
+    void _setPending( const QTextBlock& );
+
+    //* clear pending blocks
+    void _clearPending();
+
+    //* highlight pending blocks synchronously
+    void _highlightPending();
+
+    //* cancel background highlighting, and ignore pending results
+    void _cancelThread();
+
+    //* start background highlighting from first pending block
+    /** if the cancelled thread is still running, it is restarted once finished */
+    void _startThread();
+
+    //* restart background highlighting, if needed, when the thread has finished
+    void _threadFinished();
+
+    //* send visible blocks to thread
+    void _updateVisibleBlocks();
+
+    //* apply speculative locations to pending blocks
+    /** block state is left unchanged and blocks are kept modified */
+    void _applySpeculativeResult( const TextHighlightThread::Result& );
+
+    //* apply locations to blocks. Returns true if block delimiters have changed
+    bool _applyResult( const TextHighlightThread::Result& );
+
+    //* apply locations to a given block. Returns true if changed
+    bool _applyLocations( QTextBlock, const PatternLocationSet&, bool& segmentsChanged );
+
+    //* maximum time spent highlighting synchronously, per event loop pass (ms)
+    static const int maxSynchronousTime = 10;
+
+    //* delay before restarting background highlighting after a document change (ms)
+    /** consecutive changes, e.g. while typing, result in a single restart */
+    static const int restartDelay = 150;
+
+    //* true if enabled
+    bool asynchronous_ = false;
+
+    //* highlighting thread
+    TextHighlightThread* thread_ = nullptr;
+
+    //* serial of current thread request
+    /** incremented each time the thread is started or cancelled, to discard outdated results */
+    int serial_ = 0;
+
+    //* first block waiting for background highlighting
+    QTextCursor pendingCursor_;
+
+    //* last block waiting for background highlighting
+    QTextCursor pendingEndCursor_;
+
+    //* true when thread must be restarted
+    bool restartNeeded_ = false;
+
+    //* true when applying speculative locations
+    bool speculative_ = false;
+
+    //* time spent highlighting synchronously during current event loop pass
+    QElapsedTimer elapsedTimer_;
+
+    //* event loop timer, used to reset synchronous highlighting time and start thread
+    QBasicTimer timer_;
+
+    //* background highlighting restart timer, after document changes
+    QBasicTimer restartTimer_;
+
+    //* first visible block
+    int firstVisibleBlock_ = -1;
+
+    //* last visible block
+    int lastVisibleBlock_ = -1;
+
+    //@}
+
+    //*@name long lines
+    //@{
+
+    //* retrieve highlight locations and delimiters for a long block, window by window
+    /**
+    windows are retrieved from the cache when possible. Others are highlighted
+    until the synchronous highlighting time is exhausted.
+    Returns false if the end of the block was not reached
+    */
+    bool _longLineLocationSet( const QString&, int activeId, PatternLocationSet&, TextBlock::Delimiter::List& );
+
+    //* mark long block as waiting for the next highlighting pass
+    void _setLongLinePending( const QTextBlock& );
+
+    //* block size (in characters) above which blocks are highlighted by windows
+    static const int longLineSize = 16384;
+
+    //* highlighted windows
+    HighlightWindowCache windowCache_;
+
+    //* long blocks waiting for the next highlighting pass
+    QList<QTextCursor> longLineCursors_;
+
+    //@}
+
+    //*@name lazy highlighting
+    //@{
+
+    //* true if block is close enough to the visible ones to be highlighted
+    bool _isLazyVisible( const QTextBlock& ) const;
+
+    //* highlight visible blocks that are not up to date
+    void _highlightVisibleBlocks();
+
+    //* active id at the beginning of a given block
+    /** it is computed from the closest checkpoint, or from the previous block if just highlighted */
+    int _lazyActiveId( const QTextBlock& );
+
+    //* store checkpoint if block matches next missing one
+    void _storeCheckpoint( int, int );
+
+    //* store last highlighted block and its state
+    void _setLastLazyBlock( int, int );
+
+    //* clear checkpoints located after a given block
+    void _clearCheckpoints( int = 0 );
+
+    //* number of blocks between two checkpoints
+    static const int checkpointInterval = 256;
+
+    //* number of blocks highlighted above and below the visible ones
+    static const int lazyMargin = 64;
+
+    //* document size above which highlighting is lazy
+    int lazySize_ = 0;
+
+    //* active id at the beginning of every checkpointInterval block
+    QVector<int> checkpoints_;
+
+    //* last highlighted block
+    int lastLazyBlock_ = -1;
+
+    //* state of last highlighted block
+    int lastLazyActiveId_ = -1;
+
+    //@}
+
+    //*@name highlight cache
+    //@{
+
+    //* retrieve cached locations for current block. Returns false if not valid
+    bool _cachedLocationSet( const QString&, int activeId, PatternLocationSet::Compact& ) const;
+
+    //* cached locations
+    HighlightCache::Locations cachedLocations_;
+
+    //* store locations in the highlight cache, if all blocks are up to date
+    void _storeCache();
+
+    //* highlight cache key
+    QByteArray cacheKey_;
+
+    //@}
+
     //*@name text parenthesis
     //@{
 
@@ -236,6 +543,13 @@ class TextHighlight: public QSyntaxHighlighter, private Base::Counter<TextHighli
     //* block delimiters
     BlockDelimiter::List blockDelimiters_;
 
+    //* regular expression matching any of the block delimiters, each in its own capture group
+    QRegularExpression blockDelimitersRegexp_;
+
+    //* capture group of each block delimiter in the combined regular expression
+    /** empty when delimiters cannot be combined */
+    QVector<int> blockDelimiterGroups_;
+
     //@}
 
     #if WITH_ASPELL
@@ -247,6 +561,19 @@ class TextHighlight: public QSyntaxHighlighter, private Base::Counter<TextHighli
 
     //* spellcheck highlight pattern
     HighlightPattern spellPattern_;
+
+    //* spell check thread
+    SpellCheckThread* spellCheckThread_ = nullptr;
+
+    //* true if some checked blocks could not be found, due to edits
+    bool spellCheckResultsLost_ = false;
+
+    //* queue current block for spell checking
+    void _addSpellCheckRequest( const QString& );
+
+    //* apply results from background spell checking
+    void _processSpellCheckResults();
+
     //@}
 
     #endif
@@ -0,0 +1,269 @@
+/******************************************************************************
+*
+* Copyright (C) 2002 Hugo PEREIRA <mailto: hugo.pereira@free.fr>
+*
+* This is free software; you can redistribute it and/or modify it under the
+* terms of the GNU General Public License as published by the Free Software
+* Foundation; either version 2 of the License, or (at your option) any later
+* version.
+*
+* This software is distributed in the hope that it will be useful, but WITHOUT
+* Any WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along with
+* this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*******************************************************************************/
+
+#include "TextHighlightThread.h"
+#include "Debug.h"
+#include "TextHighlight.h"
+
+#include <QElapsedTimer>
+#include <QRunnable>
+#include <QThreadPool>
+
+#include <functional>
+
+namespace
+{
+    //* run a function from a thread pool
+    class Runnable final: public QRunnable
+    {
+        public:
+
+        //* constructor
+        explicit Runnable( std::function<void()> function ):
+            function_( std::move( function ) )
+        {}
+
+        //* run
+        void run() override
+        { function_(); }
+
+        private:
+
+        //* function
+        std::function<void()> function_;
+
+    };
+}
+
+//_______________________________________________________________
+TextHighlightThread::TextHighlightThread( QObject* parent ):
+    QThread( parent ),
+    Counter( QStringLiteral("TextHighlightThread") )
+{}
+
+//_______________________________________________________________
+TextHighlightThread::~TextHighlightThread()
+{
+    cancel();
+    wait();
+}
+
+//_______________________________________________________________
+void TextHighlightThread::setPatterns( const HighlightPatternSet::Pointer& patterns )
+{
+    QMutexLocker locker( &mutex_ );
+    patterns_ = patterns;
+}
+
+//_______________________________________________________________
+void TextHighlightThread::setText( int serial, const QString& text, int firstBlock, int activeId )
+{
+    QMutexLocker locker( &mutex_ );
+    aborted_.storeRelease( 0 );
+    serial_ = serial;
+    text_ = text;
+    firstBlock_ = firstBlock;
+    activeId_ = activeId;
+    visibleBlocksChanged_ = true;
+}
+
+//_______________________________________________________________
+void TextHighlightThread::setVisibleBlocks( int first, int last, int activeId )
+{
+    QMutexLocker locker( &mutex_ );
+    if( first == firstVisibleBlock_ && last == lastVisibleBlock_ && activeId == visibleActiveId_ ) return;
+    firstVisibleBlock_ = first;
+    lastVisibleBlock_ = last;
+    visibleActiveId_ = activeId;
+    visibleBlocksChanged_ = true;
+}
+
+//_______________________________________________________________
+TextHighlightThread::Result::List TextHighlightThread::takeResults()
+{
+    QMutexLocker locker( &mutex_ );
+    Result::List out;
+    out.swap( results_ );
+    return out;
+}
+
+//_______________________________________________________________
+void TextHighlightThread::run()
+{
+
+    // store block positions, with an extra entry past the end of the text
+    blockPositions_.clear();
+    blockPositions_.append( 0 );
+    for( int index = text_.indexOf( QChar::ParagraphSeparator ); index >= 0 && !_isAborted(); index = text_.indexOf( QChar::ParagraphSeparator, index+1 ) )
+    { blockPositions_.append( index+1 ); }
+    blockPositions_.append( text_.size()+1 );
+
+    speculativeBlock_ = 0;
+    speculativeLocations_.clear();
+
+    // visible blocks first, then chunks in parallel
+    _processVisibleBlocks( 0 );
+    _processChunks();
+
+    QElapsedTimer timer;
+    timer.start();
+
+    Result result( serial_, firstBlock_ );
+    int activeId( activeId_ );
+    const int blockCount( blockPositions_.size()-1 );
+    for( int block = 0; block < blockCount && !_isAborted(); ++block )
+    {
+
+        // give visible blocks a chance between two results
+        if( result.locations().empty() ) _processVisibleBlocks( block );
+
+        // reuse speculative locations when the guessed active id turns out to be right
+        const int index( block - speculativeBlock_ );
+        if( index >= 0 && index < speculativeLocations_.size() && speculativeLocations_[index].activeId().first == activeId )
+        {
+
+            result.locations().append( speculativeLocations_[index] );
+
+        } else if( block < chunkLocations_.size() && chunkLocations_.at( block ).activeId().first == activeId ) {
+
+            // same for chunk locations
+            result.locations().append( PatternLocationSet( chunkLocations_.at( block ) ) );
+
+        } else {
+
+            result.locations().append( TextHighlight::highlightLocationSet( *patterns_, _blockText( block ), activeId ) );
+
+        }
+
+        activeId = result.locations().last().activeId().second;
+
+        // send results
+        if( result.locations().size() >= maxBatchSize || timer.elapsed() > maxBatchTime )
+        {
+            _addResult( std::move( result ) );
+            result = Result( serial_, firstBlock_ + block + 1 );
+            timer.restart();
+        }
+
+    }
+
+    if( !( _isAborted() || result.locations().empty() ) )
+    { _addResult( std::move( result ) ); }
+
+    text_.clear();
+    chunkLocations_.clear();
+
+}
+
+//_______________________________________________________________
+QString TextHighlightThread::_blockText( int block ) const
+{
+    const int position( blockPositions_[block] );
+    return text_.mid( position, blockPositions_[block+1] - position - 1 );
+}
+
+//_______________________________________________________________
+void TextHighlightThread::_processVisibleBlocks( int currentBlock )
+{
+
+    int first = 0;
+    int last = 0;
+    int activeId = 0;
+
+    {
+        QMutexLocker locker( &mutex_ );
+        if( !visibleBlocksChanged_ ) return;
+        visibleBlocksChanged_ = false;
+
+        first = firstVisibleBlock_ - firstBlock_;
+        last = lastVisibleBlock_ - firstBlock_;
+        activeId = visibleActiveId_;
+    }
+
+    // blocks that are next in line need not be guessed
+    last = qMin( last, blockPositions_.size()-2 );
+    if( first <= currentBlock || first > last ) return;
+
+    Debug::Throw() << "TextHighlightThread::_processVisibleBlocks - blocks: " << firstBlock_ + first << "-" << firstBlock_ + last << Qt::endl;
+
+    Result result( serial_, firstBlock_ + first, true );
+    for( int block = first; block <= last && !_isAborted(); ++block )
+    {
+        result.locations().append( TextHighlight::highlightLocationSet( *patterns_, _blockText( block ), activeId ) );
+        activeId = result.locations().last().activeId().second;
+    }
+
+    if( _isAborted() ) return;
+
+    speculativeBlock_ = first;
+    speculativeLocations_ = result.locations();
+    _addResult( std::move( result ) );
+
+}
+
+//_______________________________________________________________
+void TextHighlightThread::_processChunks()
+{
+
+    chunkLocations_.clear();
+
+    const int blockCount( blockPositions_.size()-1 );
+    const int threadCount( QThread::idealThreadCount() );
+    if( threadCount < 2 || blockCount < minParallelBlocks || _isAborted() ) return;
+
+    // a few chunks per thread, to balance blocks of uneven length
+    const int chunkSize( qMax<int>( minChunkSize, blockCount/(4*threadCount) ) );
+    Debug::Throw() << "TextHighlightThread::_processChunks - blocks: " << blockCount << " chunk size: " << chunkSize << Qt::endl;
+
+    chunkLocations_.resize( blockCount );
+    auto locations = chunkLocations_.data();
+
+    QThreadPool pool;
+    for( int first = 0; first < blockCount; first += chunkSize )
+    {
+        const int last( qMin( first + chunkSize, blockCount ) );
+        pool.start( new Runnable( [this, locations, first, last]()
+        {
+            // only the first chunk knows its actual incoming active id
+            int activeId( first == 0 ? activeId_:0 );
+            for( int block = first; block < last && !_isAborted(); ++block )
+            {
+                const auto blockLocations( TextHighlight::highlightLocationSet( *patterns_, _blockText( block ), activeId ) );
+                activeId = blockLocations.activeId().second;
+                locations[block] = PatternLocationSet::Compact( blockLocations );
+            }
+        } ) );
+    }
+
+    // keep visible blocks up to date while waiting
+    while( !pool.waitForDone( maxBatchTime ) )
+    { _processVisibleBlocks( 0 ); }
+
+}
+
+//_______________________________________________________________
+void TextHighlightThread::_addResult( Result&& result )
+{
+    {
+        QMutexLocker locker( &mutex_ );
+        results_.append( std::move( result ) );
+    }
+
+    emit resultsAvailable();
+}
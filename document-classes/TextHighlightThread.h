@@ -0,0 +1,236 @@
+#ifndef TextHighlightThread_h
+#define TextHighlightThread_h
+
+/******************************************************************************
+*
+* Copyright (C) 2002 Hugo PEREIRA <mailto: hugo.pereira@free.fr>
+*
+* This is free software; you can redistribute it and/or modify it under the
+* terms of the GNU General Public License as published by the Free Software
+* Foundation; either version 2 of the License, or (at your option) any later
+* version.
+*
+* This software is distributed in the hope that it will be useful, but WITHOUT
+* Any WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along with
+* this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*******************************************************************************/
+
+#include "Counter.h"
+#include "HighlightPatternSet.h"
+#include "PatternLocationSet.h"
+
+#include <QAtomicInt>
+#include <QList>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <QVector>
+
+//* computes highlight locations of consecutive text blocks in a separate thread
+/**
+blocks are processed in document order, starting from a given block and active pattern id.
+When visible blocks are not reached yet, they are processed first, using an active pattern id guessed from
+the current document state. Results are sent back to the main thread in batches.
+
+For large requests, blocks are first split into chunks that are processed in parallel, assuming
+no active pattern at the beginning of each chunk. The sequential pass then reuses these locations
+whenever the assumption turns out to be right, and recomputes the others
+*/
+class TextHighlightThread: public QThread, private Base::Counter<TextHighlightThread>
+{
+
+    Q_OBJECT
+
+    public:
+
+    //* constructor
+    explicit TextHighlightThread( QObject* );
+
+    //* destructor
+    ~TextHighlightThread() override;
+
+    //* highlight locations for a range of consecutive blocks
+    class Result
+    {
+
+        public:
+
+        //* list
+        using List = QList<Result>;
+
+        //* constructor
+        explicit Result( int serial = 0, int firstBlock = 0, bool speculative = false ):
+            serial_( serial ),
+            firstBlock_( firstBlock ),
+            speculative_( speculative )
+        {}
+
+        //* serial of the request from which results are computed
+        int serial() const
+        { return serial_; }
+
+        //* first block number
+        int firstBlock() const
+        { return firstBlock_; }
+
+        //* true if locations were computed from a guessed active pattern id
+        bool isSpeculative() const
+        { return speculative_; }
+
+        //* locations, one per block
+        const QVector<PatternLocationSet>& locations() const
+        { return locations_; }
+
+        //* locations, one per block
+        QVector<PatternLocationSet>& locations()
+        { return locations_; }
+
+        private:
+
+        //* serial
+        int serial_ = 0;
+
+        //* first block
+        int firstBlock_ = 0;
+
+        //* speculative
+        bool speculative_ = false;
+
+        //* locations
+        QVector<PatternLocationSet> locations_;
+
+    };
+
+    //*@name modifiers
+    //@{
+
+    //* patterns
+    void setPatterns( const HighlightPatternSet::Pointer& );
+
+    //* text to be processed
+    /**
+    text is the raw document text, from the beginning of firstBlock to the end of the document,
+    with blocks separated by paragraph separators. Processing uses activeId as the state
+    of the previous block. Must not be called while running
+    */
+    void setText( int serial, const QString& text, int firstBlock, int activeId );
+
+    //* visible blocks, and guessed active pattern id for the first one
+    void setVisibleBlocks( int first, int last, int activeId );
+
+    //* cancel current processing
+    void cancel()
+    { aborted_.storeRelease( 1 ); }
+
+    //* retrieve and clear available results
+    Result::List takeResults();
+
+    //@}
+
+    Q_SIGNALS:
+
+    //* emitted when new results are available
+    void resultsAvailable();
+
+    protected:
+
+    //* process text
+    void run() override;
+
+    private:
+
+    //* true if processing was cancelled
+    bool _isAborted() const
+    { return aborted_.loadAcquire(); }
+
+    //* text of a given block, relative to first block
+    QString _blockText( int ) const;
+
+    //* process visible blocks, if changed and not reached yet
+    void _processVisibleBlocks( int );
+
+    //* process chunks of blocks in parallel
+    void _processChunks();
+
+    //* store result and notify
+    void _addResult( Result&& );
+
+    //* maximum number of blocks per result
+    static const int maxBatchSize = 256;
+
+    //* maximum time spent per result (ms)
+    static const int maxBatchTime = 50;
+
+    //* minimum number of blocks for parallel processing
+    static const int minParallelBlocks = 2048;
+
+    //* minimum number of blocks per chunk
+    static const int minChunkSize = 256;
+
+    //* mutex
+    QMutex mutex_;
+
+    //* true if processing was cancelled
+    QAtomicInt aborted_;
+
+    //* highlight patterns
+    /** they are immutable, and can be used from this and the pool threads without copying */
+    HighlightPatternSet::Pointer patterns_ = HighlightPatternSet::emptySet();
+
+    //*@name request
+    //@{
+
+    //* serial
+    int serial_ = 0;
+
+    //* text
+    QString text_;
+
+    //* first block number
+    int firstBlock_ = 0;
+
+    //* active id of the block preceding the first block
+    int activeId_ = 0;
+
+    //* start position of each block in text, relative to first block
+    QVector<int> blockPositions_;
+
+    //@}
+
+    //*@name visible blocks
+    //@{
+
+    //* first visible block number
+    int firstVisibleBlock_ = -1;
+
+    //* last visible block number
+    int lastVisibleBlock_ = -1;
+
+    //* guessed active id for first visible block
+    int visibleActiveId_ = 0;
+
+    //* true when visible blocks have changed and need processing
+    bool visibleBlocksChanged_ = false;
+
+    //* first block for which speculative locations are available, relative to first block
+    int speculativeBlock_ = 0;
+
+    //* speculative locations
+    QVector<PatternLocationSet> speculativeLocations_;
+
+    //@}
+
+    //* locations computed in parallel, one per block, relative to first block
+    QVector<PatternLocationSet::Compact> chunkLocations_;
+
+    //* pending results
+    Result::List results_;
+
+};
+
+#endif
@@ -27,6 +27,7 @@
 #include <QDomDocument>
 #include <QRegularExpression>
 #include <QList>
+#include <QStringView>
 
 //* text parenthesis (for highlighting)
 class TextParenthesis final: private Base::Counter<TextParenthesis>
@@ -98,19 +99,24 @@ class TextParenthesis final: private Base::Counter<TextParenthesis>
         public:
 
         //* constructor
-        explicit FirstElementFTor( const QString& text ):
-            text_( text )
+        /** parenthesis must end at given position in text */
+        explicit FirstElementFTor( const QString& text, int position ):
+            text_( text ),
+            position_( position )
         {}
 
         //* predicate
         bool operator() ( const TextParenthesis& parenthesis ) const
-        { return text_.right( parenthesis.first().size() ) == parenthesis.first(); }
+        { return QStringView( text_ ).left( position_ ).endsWith( parenthesis.first() ); }
 
         private:
 
         //* predicted character
         const QString& text_;
 
+        //* position
+        int position_ = 0;
+
     };
 
     //* used to find parenthesis for which first character match
@@ -119,19 +125,24 @@ class TextParenthesis final: private Base::Counter<TextParenthesis>
         public:
 
         //* constructor
-        explicit SecondElementFTor( const QString& text ):
-            text_( text )
+        /** parenthesis must end at given position in text */
+        explicit SecondElementFTor( const QString& text, int position ):
+            text_( text ),
+            position_( position )
         {}
 
         //* predicate
         bool operator() ( const TextParenthesis& parenthesis ) const
-        { return text_.right( parenthesis.second().size() ) == parenthesis.second(); }
+        { return QStringView( text_ ).left( position_ ).endsWith( parenthesis.second() ); }
 
         private:
 
         //* predicted character
         const QString& text_;
 
+        //* position
+        int position_ = 0;
+
     };
 
     private:
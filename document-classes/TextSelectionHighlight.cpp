@@ -0,0 +1,273 @@
+/******************************************************************************
+*
+* Copyright (C) 2002 Hugo PEREIRA <mailto: hugo.pereira@free.fr>
+*
+* This is free software; you can redistribute it and/or modify it under the
+* terms of the GNU General Public License as published by the Free Software
+* Foundation; either version 2 of the License, or (at your option) any later
+* version.
+*
+* This software is distributed in the hope that it will be useful, but WITHOUT
+* Any WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along with
+* this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*******************************************************************************/
+
+#include "TextSelectionHighlight.h"
+#include "TextEditor.h"
+
+#include <QElapsedTimer>
+#include <QTextDocument>
+
+#include <algorithm>
+
+//_______________________________________________________________________
+TextSelectionHighlight::TextSelectionHighlight( TextEditor* parent ):
+    QObject( parent ),
+    Counter( QStringLiteral("TextSelectionHighlight") ),
+    parent_( parent )
+{ Debug::Throw( QStringLiteral("TextSelectionHighlight::TextSelectionHighlight.\n") ); }
+
+//_______________________________________________________________________
+void TextSelectionHighlight::setColor( const QColor& color )
+{
+    if( color == color_ ) return;
+    color_ = color;
+    update();
+}
+
+//_______________________________________________________________________
+bool TextSelectionHighlight::setTextSelection( const TextSelection& textSelection )
+{
+
+    const bool changed =
+        (textSelection_.hasFlag( TextSelection::HighlightAll ) != textSelection.hasFlag( TextSelection::HighlightAll ) ) ||
+        (textSelection_.hasFlag( TextSelection::CaseSensitive ) != textSelection.hasFlag( TextSelection::CaseSensitive ) ) ||
+        (textSelection_.hasFlag( TextSelection::EntireWord ) != textSelection.hasFlag( TextSelection::EntireWord ) ) ||
+        (textSelection_.hasFlag( TextSelection::RegExp ) != textSelection.hasFlag( TextSelection::RegExp ) ) ||
+        (textSelection_.text() != textSelection.text());
+
+    // check if changed
+    if( !changed ) return false;
+
+    // if highlight all has not changed and is false, also do nothing
+    if( !( textSelection_.hasFlag( TextSelection::HighlightAll ) || textSelection.hasFlag( TextSelection::HighlightAll ) ) )
+    {
+        textSelection_ = textSelection;
+        return false;
+    }
+
+    // update stored selection
+    textSelection_ = textSelection;
+
+    // update regular expression
+    if( !textSelection.hasFlag( TextSelection::HighlightAll ) || textSelection.text().isEmpty() )
+    {
+        regularExpression_ = QRegularExpression();
+    } else {
+        if( textSelection.hasFlag( TextSelection::RegExp ) ) regularExpression_.setPattern( textSelection.text() );
+        else {
+            auto escaped = QRegularExpression::escape( textSelection.text() );
+            if( textSelection.hasFlag( TextSelection::EntireWord )) escaped = QStringLiteral( "\\b" ) + escaped + QStringLiteral( "\\b" );
+            regularExpression_.setPattern( escaped );
+        }
+
+        regularExpression_.setPatternOptions( textSelection.hasFlag( TextSelection::CaseSensitive ) ?
+            QRegularExpression::NoPatternOption:
+            QRegularExpression::CaseInsensitiveOption );
+    }
+
+    _restartCount();
+    update();
+    return true;
+
+}
+
+//_______________________________________________________________________
+void TextSelectionHighlight::synchronize( const TextSelectionHighlight& other )
+{
+    Debug::Throw( QStringLiteral("TextSelectionHighlight::synchronize.\n") );
+    color_ = other.color_;
+    textSelection_ = other.textSelection_;
+    regularExpression_ = other.regularExpression_;
+    _restartCount();
+    update();
+}
+
+//_______________________________________________________________________
+void TextSelectionHighlight::update()
+{
+
+    updateTimer_.stop();
+
+    QList<QTextEdit::ExtraSelection> selections;
+    if( isEnabled() )
+    {
+
+        QTextCharFormat format;
+        format.setBackground( color_ );
+        format.setProperty( selectionProperty, true );
+
+        // loop over visible blocks
+        const auto first( parent_->cursorForPosition( QPoint( 0, 0 ) ).block() );
+        const auto last( parent_->cursorForPosition( QPoint( 0, parent_->viewport()->height() ) ).block() );
+        for( auto block = first; block.isValid() && block.blockNumber() <= last.blockNumber(); block = block.next() )
+        {
+
+            auto iter( regularExpression_.globalMatch( block.text() ) );
+            while( iter.hasNext() )
+            {
+                const auto match( iter.next() );
+                if( !match.capturedLength() ) continue;
+
+                QTextCursor cursor( block );
+                cursor.setPosition( block.position() + match.capturedStart() );
+                cursor.setPosition( block.position() + match.capturedEnd(), QTextCursor::KeepAnchor );
+                selections.append( { cursor, format } );
+            }
+
+        }
+
+    }
+
+    // replace previous matches, keeping other extra selections
+    auto extraSelections( parent_->extraSelections() );
+    const auto iter( std::remove_if( extraSelections.begin(), extraSelections.end(),
+        []( const QTextEdit::ExtraSelection& selection ) { return selection.format.hasProperty( selectionProperty ); } ) );
+
+    // do nothing if there was nothing highlighted either
+    if( selections.isEmpty() && iter == extraSelections.end() ) return;
+    extraSelections.erase( iter, extraSelections.end() );
+    extraSelections.append( selections );
+    parent_->setExtraSelections( extraSelections );
+
+}
+
+//_______________________________________________________________________
+void TextSelectionHighlight::setContentsChanged( int position, int, int added )
+{
+    if( !isEnabled() ) return;
+
+    // the update is delayed until the document layout is up to date
+    updateTimer_.start( 0, this );
+
+    // counting is restarted if not complete
+    if( counting_ )
+    {
+        _restartCount();
+        return;
+    }
+
+    // modified blocks, after the change
+    const auto document( parent_->document() );
+    const auto first( document->findBlock( position ) );
+    auto last( document->findBlock( position + added ) );
+    if( !last.isValid() ) last = document->lastBlock();
+
+    // modified blocks, before the change, from the change in block count
+    const int firstNumber( first.blockNumber() );
+    const int removedCount( last.blockNumber() - firstNumber + 1 - ( document->blockCount() - blockCounts_.size() ) );
+    if( firstNumber < 0 || removedCount < 0 || firstNumber + removedCount > blockCounts_.size() )
+    {
+        _restartCount();
+        return;
+    }
+
+    // replace counts of modified blocks
+    for( int index = firstNumber; index < firstNumber + removedCount; ++index )
+    { count_ -= blockCounts_[index]; }
+
+    QVector<int> counts;
+    for( auto block = first; block.isValid() && block.blockNumber() <= last.blockNumber(); block = block.next() )
+    {
+        counts.append( _count( block ) );
+        count_ += counts.last();
+    }
+
+    blockCounts_.remove( firstNumber, removedCount );
+    blockCounts_.insert( firstNumber, counts.size(), 0 );
+    std::copy( counts.begin(), counts.end(), blockCounts_.begin() + firstNumber );
+
+    if( count_ == matchCount_ ) return;
+    matchCount_ = count_;
+    emit matchCountChanged();
+}
+
+//_______________________________________________________________________
+void TextSelectionHighlight::timerEvent( QTimerEvent* event )
+{
+
+    if( event->timerId() == updateTimer_.timerId() ) update();
+    else if( event->timerId() == countTimer_.timerId() ) _countMatches();
+    else return QObject::timerEvent( event );
+
+}
+
+//_______________________________________________________________________
+void TextSelectionHighlight::_restartCount()
+{
+
+    const bool wasCounting( counting_ );
+    if( isEnabled() )
+    {
+
+        countBlock_ = parent_->document()->begin();
+        count_ = 0;
+        blockCounts_.clear();
+        counting_ = true;
+        countTimer_.start( 0, this );
+
+    } else {
+
+        countTimer_.stop();
+        countBlock_ = QTextBlock();
+        count_ = 0;
+        blockCounts_.clear();
+        matchCount_ = 0;
+        counting_ = false;
+
+    }
+
+    // match count is unknown while counting
+    if( !( wasCounting && counting_ ) ) emit matchCountChanged();
+
+}
+
+//_______________________________________________________________________
+void TextSelectionHighlight::_countMatches()
+{
+
+    QElapsedTimer timer;
+    timer.start();
+    while( countBlock_.isValid() && !timer.hasExpired( maxCountTime ) )
+    {
+
+        blockCounts_.append( _count( countBlock_ ) );
+        count_ += blockCounts_.last();
+        countBlock_ = countBlock_.next();
+
+    }
+
+    // continue at next event loop
+    if( countBlock_.isValid() ) return;
+
+    countTimer_.stop();
+    counting_ = false;
+    matchCount_ = count_;
+    emit matchCountChanged();
+
+}
+
+//_______________________________________________________________________
+int TextSelectionHighlight::_count( const QTextBlock& block ) const
+{
+    int count( 0 );
+    auto iter( regularExpression_.globalMatch( block.text() ) );
+    while( iter.hasNext() )
+    { if( iter.next().capturedLength() ) ++count; }
+    return count;
+}
@@ -0,0 +1,165 @@
+#ifndef TextSelectionHighlight_h
+#define TextSelectionHighlight_h
+
+/******************************************************************************
+*
+* Copyright (C) 2002 Hugo PEREIRA <mailto: hugo.pereira@free.fr>
+*
+* This is free software; you can redistribute it and/or modify it under the
+* terms of the GNU General Public License as published by the Free Software
+* Foundation; either version 2 of the License, or (at your option) any later
+* version.
+*
+* This software is distributed in the hope that it will be useful, but WITHOUT
+* Any WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along with
+* this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*******************************************************************************/
+
+/**
+\file TextSelectionHighlight.h
+\brief highlights all occurences of the text selection in the visible blocks
+\author Hugo Pereira
+\version $Revision$
+\date $Date$
+*/
+
+#include <QBasicTimer>
+#include <QColor>
+#include <QObject>
+#include <QRegularExpression>
+#include <QTextBlock>
+#include <QTimerEvent>
+#include <QVector>
+
+#include "Counter.h"
+#include "Debug.h"
+#include "TextSelection.h"
+
+class TextEditor;
+
+/**
+\class TextSelectionHighlight
+\brief highlights all occurences of the text selection
+matches are shown as extra selections of the parent editor, for the visible blocks only,
+so that neither the syntax highlighting nor the block formats are touched when the selection changes.
+Other extra selections of the editor are left unchanged.
+The number of matches in the whole document is counted in the background, a few blocks at a time,
+and then updated for modified blocks only.
+*/
+class TextSelectionHighlight: public QObject, private Base::Counter<TextSelectionHighlight>
+{
+
+    Q_OBJECT
+
+    public:
+
+    //* constructor
+    explicit TextSelectionHighlight( TextEditor* );
+
+    //* maximum time spent counting matches before returning to the event loop (ms)
+    static const int maxCountTime = 10;
+
+    //*@name accessors
+    //@{
+
+    //* color
+    const QColor& color() const
+    { return color_; }
+
+    //* true if there is a text selection to highlight
+    bool isEnabled() const
+    { return !regularExpression_.pattern().isEmpty() && regularExpression_.isValid(); }
+
+    //* number of matches in the document
+    /** returns -1 while matches are being counted or if highlighting is disabled */
+    int matchCount() const
+    { return ( isEnabled() && !counting_ ) ? matchCount_:-1; }
+
+    //@}
+
+    //*@name modifiers
+    //@{
+
+    //* color
+    void setColor( const QColor& );
+
+    //* text selection. Returns true if changed
+    bool setTextSelection( const TextSelection& );
+
+    //* synchronize
+    void synchronize( const TextSelectionHighlight& );
+
+    //* update the highlighted matches in the visible blocks
+    void update();
+
+    //* document contents have changed
+    /** arguments are those of QTextDocument::contentsChange */
+    void setContentsChanged( int position, int removed, int added );
+
+    //@}
+
+    Q_SIGNALS:
+
+    //* emitted when the document match count changes
+    void matchCountChanged();
+
+    protected:
+
+    //* timer event
+    void timerEvent( QTimerEvent* ) override;
+
+    private:
+
+    //* restart counting matches from the start of the document
+    void _restartCount();
+
+    //* count matches, until the end of the document or the time limit is reached
+    void _countMatches();
+
+    //* number of matches in a given block
+    int _count( const QTextBlock& ) const;
+
+    //* char format property marking extra selections that belong to this object
+    static const int selectionProperty = QTextFormat::UserProperty | (1<<2);
+
+    //* parent editor
+    TextEditor* parent_ = nullptr;
+
+    //* highlight color
+    QColor color_;
+
+    //* text selection
+    TextSelection textSelection_;
+
+    //* regular expression matching the text selection
+    QRegularExpression regularExpression_;
+
+    //* timer for deferred visible blocks update
+    QBasicTimer updateTimer_;
+
+    //* timer for background match counting
+    QBasicTimer countTimer_;
+
+    //* next block to be counted
+    QTextBlock countBlock_;
+
+    //* number of matches found so far
+    int count_ = 0;
+
+    //* number of matches per block, for the blocks counted so far
+    QVector<int> blockCounts_;
+
+    //* number of matches in the document, once counted
+    int matchCount_ = 0;
+
+    //* true while counting
+    bool counting_ = false;
+
+};
+
+#endif
@@ -0,0 +1,290 @@
+/******************************************************************************
+*
+* Copyright (C) 2002 Hugo PEREIRA <mailto: hugo.pereira@free.fr>
+*
+* This is free software; you can redistribute it and/or modify it under the
+* terms of the GNU General Public License as published by the Free Software
+* Foundation; either version 2 of the License, or (at your option) any later
+* version.
+*
+* This software is distributed in the hope that it will be useful, but WITHOUT
+* Any WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along with
+* this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*******************************************************************************/
+
+#include "WordListMatcher.h"
+
+#include <algorithm>
+
+//___________________________________________________________________________
+WordListMatcher::WordListMatcher( const QRegularExpression& regexp )
+{
+
+    // options other than case sensitivity may change the meaning of word boundaries
+    if( !regexp.isValid() ) return;
+    if( regexp.patternOptions() & ~QRegularExpression::PatternOptions( QRegularExpression::CaseInsensitiveOption ) ) return;
+    if( regexp.patternOptions() & QRegularExpression::CaseInsensitiveOption )
+    { caseSensitivity_ = Qt::CaseInsensitive; }
+
+    // pattern must be enclosed in word boundaries
+    const QLatin1String boundary( "\\b" );
+    const auto pattern( regexp.pattern() );
+    if( pattern.size() <= 4 || !pattern.startsWith( boundary ) || !pattern.endsWith( boundary ) ) return;
+
+    const auto body( pattern.mid( 2, pattern.size()-4 ) );
+    int position( 0 );
+    QStringList words;
+    if( !_expandAlternatives( body, position, words ) || position != body.size() ) return;
+
+    if( caseSensitivity_ == Qt::CaseInsensitive )
+    {
+        for( auto&& word:words )
+        { word = word.toLower(); }
+    }
+
+    std::sort( words.begin(), words.end() );
+    words.erase( std::unique( words.begin(), words.end() ), words.end() );
+
+    // empty words would result in zero length matches
+    if( words.isEmpty() || words.front().isEmpty() ) return;
+
+    words_ = QVector<QString>( words.begin(), words.end() );
+    minLength_ = words_.front().size();
+    for( const auto& word:words_ )
+    {
+        minLength_ = qMin( minLength_, word.size() );
+        maxLength_ = qMax( maxLength_, word.size() );
+        if( caseSensitivity_ == Qt::CaseInsensitive && ( word.contains( QLatin1Char( 'k' ) ) || word.contains( QLatin1Char( 's' ) ) ) )
+        { hasFoldedCharacters_ = true; }
+    }
+
+    // hash table, at most half full
+    int tableSize( 16 );
+    while( tableSize < 2*words_.size() ) tableSize <<= 1;
+    table_ = QVector<int>( tableSize, -1 );
+    for( int index = 0; index < words_.size(); ++index )
+    {
+        const auto& word( words_[index] );
+        uint slot( _hash( word.constData(), word.size() ) & (tableSize-1) );
+        while( table_[slot] >= 0 ) slot = (slot+1) & (tableSize-1);
+        table_[slot] = index;
+    }
+
+}
+
+//___________________________________________________________________________
+bool WordListMatcher::accepts( const QString& text, int from, int to ) const
+{
+    const auto view( QStringView( text ).left( to ) );
+    return
+        !hasFoldedCharacters_ ||
+        ( view.indexOf( QChar( 0x212a ), from ) < 0 && view.indexOf( QChar( 0x017f ), from ) < 0 );
+}
+
+//___________________________________________________________________________
+int WordListMatcher::indexIn( const QString& text, int from, int to, int& length ) const
+{
+
+    const auto data( text.constData() );
+    const int size( qMin( to, text.size() ) );
+    int position( qMax( 0, from ) );
+
+    // skip end of word, if any
+    if( position > 0 )
+    { while( position < size && _isWordCharacter( data[position-1].unicode() ) && _isWordCharacter( data[position].unicode() ) ) ++position; }
+
+    while( position < size )
+    {
+
+        // find word start
+        while( position < size && !_isWordCharacter( data[position].unicode() ) ) ++position;
+        if( position == size ) break;
+
+        // find word end
+        const int begin( position );
+        while( position < size && _isWordCharacter( data[position].unicode() ) ) ++position;
+
+        length = position - begin;
+        if( length >= minLength_ && length <= maxLength_ && _contains( data + begin, length ) )
+        { return begin; }
+
+    }
+
+    return -1;
+
+}
+
+//___________________________________________________________________________
+bool WordListMatcher::_expandAlternatives( const QString& pattern, int& position, QStringList& words )
+{
+    words.clear();
+    forever
+    {
+        QStringList alternative;
+        if( !_expandSequence( pattern, position, alternative ) ) return false;
+        words.append( alternative );
+        if( words.size() > maxWords ) return false;
+
+        if( position < pattern.size() && pattern.at( position ) == QLatin1Char( '|' ) ) ++position;
+        else return true;
+    }
+}
+
+//___________________________________________________________________________
+bool WordListMatcher::_expandSequence( const QString& pattern, int& position, QStringList& words )
+{
+
+    words = QStringList( QString() );
+    while( position < pattern.size() && pattern.at( position ) != QLatin1Char( '|' ) && pattern.at( position ) != QLatin1Char( ')' ) )
+    {
+
+        QStringList atom;
+        if( !_expandAtom( pattern, position, atom ) ) return false;
+
+        // optional atom
+        if( position < pattern.size() && pattern.at( position ) == QLatin1Char( '?' ) )
+        {
+            ++position;
+            if( position < pattern.size() && pattern.at( position ) == QLatin1Char( '?' ) ) ++position;
+            atom.append( QString() );
+        }
+
+        if( words.size()*atom.size() > maxWords ) return false;
+
+        QStringList product;
+        product.reserve( words.size()*atom.size() );
+        for( const auto& word:words )
+        {
+            for( const auto& suffix:atom )
+            { product.append( word + suffix ); }
+        }
+
+        words.swap( product );
+
+    }
+
+    return true;
+
+}
+
+//___________________________________________________________________________
+bool WordListMatcher::_expandAtom( const QString& pattern, int& position, QStringList& words )
+{
+
+    words.clear();
+    const auto character( pattern.at( position ) );
+    if( _isWordCharacter( character.unicode() ) )
+    {
+
+        words.append( character );
+        ++position;
+        return true;
+
+    } else if( character == QLatin1Char( '\\' ) ) {
+
+        // digits
+        if( position+1 >= pattern.size() || pattern.at( position+1 ) != QLatin1Char( 'd' ) ) return false;
+        for( ushort digit = '0'; digit <= '9'; ++digit )
+        { words.append( QChar( digit ) ); }
+
+        position += 2;
+        return true;
+
+    } else if( character == QLatin1Char( '[' ) ) {
+
+        return _expandClass( pattern, position, words );
+
+    } else if( character == QLatin1Char( '(' ) ) {
+
+        // capture and non capture groups
+        if( position+1 < pattern.size() && pattern.at( position+1 ) == QLatin1Char( '?' ) )
+        {
+            if( position+2 >= pattern.size() || pattern.at( position+2 ) != QLatin1Char( ':' ) ) return false;
+            position += 3;
+        } else ++position;
+
+        if( !_expandAlternatives( pattern, position, words ) ) return false;
+        if( position >= pattern.size() || pattern.at( position ) != QLatin1Char( ')' ) ) return false;
+        ++position;
+        return true;
+
+    } else return false;
+
+}
+
+//___________________________________________________________________________
+bool WordListMatcher::_expandClass( const QString& pattern, int& position, QStringList& words )
+{
+
+    // only non negated classes of word characters are supported
+    ++position;
+    while( position < pattern.size() && pattern.at( position ) != QLatin1Char( ']' ) )
+    {
+
+        const auto first( pattern.at( position ).unicode() );
+        if( !_isWordCharacter( first ) ) return false;
+
+        // ranges
+        ushort last( first );
+        if( position+2 < pattern.size() && pattern.at( position+1 ) == QLatin1Char( '-' ) && pattern.at( position+2 ) != QLatin1Char( ']' ) )
+        {
+            last = pattern.at( position+2 ).unicode();
+            if( last < first ) return false;
+            position += 3;
+        } else ++position;
+
+        for( ushort current = first; current <= last; ++current )
+        {
+            if( !_isWordCharacter( current ) ) return false;
+            words.append( QChar( current ) );
+        }
+
+    }
+
+    if( position >= pattern.size() || words.isEmpty() ) return false;
+    ++position;
+    return true;
+
+}
+
+//___________________________________________________________________________
+uint WordListMatcher::_hash( const QChar* data, int length ) const
+{
+    // fnv-1a
+    uint hash( 2166136261u );
+    for( int i = 0; i < length; ++i )
+    {
+        const ushort character( data[i].unicode() );
+        hash ^= ( caseSensitivity_ == Qt::CaseInsensitive ) ? _toLower( character ):character;
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+//___________________________________________________________________________
+bool WordListMatcher::_contains( const QChar* data, int length ) const
+{
+    const int mask( table_.size()-1 );
+    for( uint slot = _hash( data, length ) & mask; table_[slot] >= 0; slot = (slot+1) & mask )
+    {
+        const auto& word( words_[table_[slot]] );
+        if( word.size() != length ) continue;
+
+        bool same( true );
+        for( int i = 0; i < length && same; ++i )
+        {
+            const ushort character( data[i].unicode() );
+            same = word.at(i).unicode() == ( ( caseSensitivity_ == Qt::CaseInsensitive ) ? _toLower( character ):character );
+        }
+
+        if( same ) return true;
+    }
+
+    return false;
+}
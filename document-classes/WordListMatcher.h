@@ -0,0 +1,135 @@
+#ifndef WordListMatcher_h
+#define WordListMatcher_h
+
+/******************************************************************************
+*
+* Copyright (C) 2002 Hugo PEREIRA <mailto: hugo.pereira@free.fr>
+*
+* This is free software; you can redistribute it and/or modify it under the
+* terms of the GNU General Public License as published by the Free Software
+* Foundation; either version 2 of the License, or (at your option) any later
+* version.
+*
+* This software is distributed in the hope that it will be useful, but WITHOUT
+* Any WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along with
+* this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*******************************************************************************/
+
+#include <QRegularExpression>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+//* fast matching of word list regular expressions
+/**
+patterns of the form \b(word1|word2|...)\b, with words made only of ascii word characters,
+are expanded into the full list of matching words. The text is then split into words,
+each of which is looked up in a hash table, rather than running the regular expression at every position.
+Nested groups, optional groups, \d and simple character classes are expanded,
+provided that the number of resulting words remains reasonable
+*/
+class WordListMatcher final
+{
+
+    public:
+
+    //* default constructor
+    explicit WordListMatcher() = default;
+
+    //* constructor from regular expression
+    explicit WordListMatcher( const QRegularExpression& );
+
+    //*@name accessors
+    //@{
+
+    //* true if regular expression is a word list
+    bool isValid() const
+    { return !words_.isEmpty(); }
+
+    //* number of words
+    int size() const
+    { return words_.size(); }
+
+    //* true if matcher gives the same matches as the regular expression for this text
+    /**
+    case insensitive regular expressions also match some non ascii characters,
+    such as the kelvin sign, which are not handled by the matcher.
+    Only text in range [from, to) is checked
+    */
+    bool accepts( const QString&, int from, int to ) const;
+
+    //* position of the first matching word starting at or after from, or -1
+    /** text is considered to end at position to */
+    int indexIn( const QString&, int from, int to, int& length ) const;
+
+    //@}
+
+    //* maximum number of words
+    static const int maxWords = 1<<16;
+
+    private:
+
+    //*@name expansion
+    //@{
+
+    //* expand alternatives up to closing parenthesis or end of pattern
+    static bool _expandAlternatives( const QString&, int&, QStringList& );
+
+    //* expand a sequence of atoms
+    static bool _expandSequence( const QString&, int&, QStringList& );
+
+    //* expand atom
+    static bool _expandAtom( const QString&, int&, QStringList& );
+
+    //* expand character class
+    static bool _expandClass( const QString&, int&, QStringList& );
+
+    //@}
+
+    //* true if character is a word character
+    static bool _isWordCharacter( ushort character )
+    {
+        return
+            ( character >= 'a' && character <= 'z' ) ||
+            ( character >= 'A' && character <= 'Z' ) ||
+            ( character >= '0' && character <= '9' ) ||
+            character == '_';
+    }
+
+    //* lower case, for ascii characters
+    static ushort _toLower( ushort character )
+    { return ( character >= 'A' && character <= 'Z' ) ? character + ('a'-'A'):character; }
+
+    //* hash
+    uint _hash( const QChar*, int ) const;
+
+    //* true if word is in list
+    bool _contains( const QChar*, int ) const;
+
+    //* case sensitivity
+    Qt::CaseSensitivity caseSensitivity_ = Qt::CaseSensitive;
+
+    //* true if the list contains characters that case insensitive regular expressions also match outside of the ascii range
+    bool hasFoldedCharacters_ = false;
+
+    //* minimum word length
+    int minLength_ = 0;
+
+    //* maximum word length
+    int maxLength_ = 0;
+
+    //* words
+    /** lower case words are stored for case insensitive matching */
+    QVector<QString> words_;
+
+    //* open addressing hash table of indices in words list, -1 for empty slots
+    QVector<int> table_;
+
+};
+
+#endif
@@ -0,0 +1,108 @@
+/******************************************************************************
+*
+* Copyright (C) 2002 Hugo PEREIRA <mailto: hugo.pereira@free.fr>
+*
+* This is free software; you can redistribute it and/or modify it under the
+* terms of the GNU General Public License as published by the Free Software
+* Foundation; either version 2 of the License, or (at your option) any later
+* version.
+*
+* This software is distributed in the hope that it will be useful, but WITHOUT
+* Any WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along with
+* this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*******************************************************************************/
+
+#include "AllocationCounter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+    //* allocation count
+    std::atomic<qint64> allocations( 0 );
+}
+
+#if defined(__GLIBC__)
+
+extern "C"
+{
+
+    void* __libc_malloc( size_t );
+    void* __libc_calloc( size_t, size_t );
+    void* __libc_realloc( void*, size_t );
+
+    //___________________________________________________________________________
+    void* malloc( size_t size )
+    {
+        allocations.fetch_add( 1, std::memory_order_relaxed );
+        return __libc_malloc( size );
+    }
+
+    //___________________________________________________________________________
+    void* calloc( size_t count, size_t size )
+    {
+        allocations.fetch_add( 1, std::memory_order_relaxed );
+        return __libc_calloc( count, size );
+    }
+
+    //___________________________________________________________________________
+    void* realloc( void* pointer, size_t size )
+    {
+        allocations.fetch_add( 1, std::memory_order_relaxed );
+        return __libc_realloc( pointer, size );
+    }
+
+}
+
+#else
+
+//___________________________________________________________________________
+void* operator new( std::size_t size )
+{
+    allocations.fetch_add( 1, std::memory_order_relaxed );
+    if( auto pointer = std::malloc( size ? size:1 ) ) return pointer;
+    throw std::bad_alloc();
+}
+
+//___________________________________________________________________________
+void* operator new[]( std::size_t size )
+{ return operator new( size ); }
+
+//___________________________________________________________________________
+void operator delete( void* pointer ) noexcept
+{ std::free( pointer ); }
+
+//___________________________________________________________________________
+void operator delete[]( void* pointer ) noexcept
+{ std::free( pointer ); }
+
+//___________________________________________________________________________
+void operator delete( void* pointer, std::size_t ) noexcept
+{ std::free( pointer ); }
+
+//___________________________________________________________________________
+void operator delete[]( void* pointer, std::size_t ) noexcept
+{ std::free( pointer ); }
+
+#endif
+
+//___________________________________________________________________________
+qint64 AllocationCounter::count()
+{ return allocations.load( std::memory_order_relaxed ); }
+
+//___________________________________________________________________________
+bool AllocationCounter::countsMalloc()
+{
+    #if defined(__GLIBC__)
+    return true;
+    #else
+    return false;
+    #endif
+}
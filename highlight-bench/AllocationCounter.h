@@ -0,0 +1,43 @@
+#ifndef AllocationCounter_h
+#define AllocationCounter_h
+
+/******************************************************************************
+*
+* Copyright (C) 2002 Hugo PEREIRA <mailto: hugo.pereira@free.fr>
+*
+* This is free software; you can redistribute it and/or modify it under the
+* terms of the GNU General Public License as published by the Free Software
+* Foundation; either version 2 of the License, or (at your option) any later
+* version.
+*
+* This software is distributed in the hope that it will be useful, but WITHOUT
+* Any WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along with
+* this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*******************************************************************************/
+
+#include <QtGlobal>
+
+//* counts heap allocations made by the process
+/**
+with glibc, malloc, calloc and realloc are intercepted, so that allocations made by Qt containers are counted.
+Otherwise only operator new is intercepted
+*/
+class AllocationCounter final
+{
+
+    public:
+
+    //* number of allocations since program start
+    static qint64 count();
+
+    //* true if all heap allocations are counted, rather than only operator new
+    static bool countsMalloc();
+
+};
+
+#endif
@@ -0,0 +1,441 @@
+/******************************************************************************
+*
+* Copyright (C) 2002 Hugo PEREIRA <mailto: hugo.pereira@free.fr>
+*
+* This is free software; you can redistribute it and/or modify it under the
+* terms of the GNU General Public License as published by the Free Software
+* Foundation; either version 2 of the License, or (at your option) any later
+* version.
+*
+* This software is distributed in the hope that it will be useful, but WITHOUT
+* Any WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along with
+* this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*******************************************************************************/
+
+#include "HighlightBenchmark.h"
+#include "AllocationCounter.h"
+#include "HighlightBlockData.h"
+#include "TextHighlight.h"
+#include "XmlDef.h"
+
+#include <QColor>
+#include <QCoreApplication>
+#include <QDomDocument>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QRegularExpression>
+#include <QSet>
+#include <QTextCursor>
+#include <QTextDocument>
+
+#include <algorithm>
+#include <random>
+
+#if defined(Q_OS_UNIX)
+#include <sys/resource.h>
+#endif
+
+//___________________________________________________________________________
+HighlightBenchmark::Result HighlightBenchmark::run( const DocumentClass& documentClass ) const
+{
+
+    Result result;
+    result.name = documentClass.name();
+    result.patternCount = documentClass.highlightPatterns().size();
+
+    const auto corpus( _corpus( documentClass ) );
+    const auto blocks( corpus.split( QLatin1Char( '\n' ) ) );
+    result.characterCount = corpus.size();
+    result.blockCount = blocks.size();
+
+    _resetPeakMemory();
+
+    for( int run = 0; run < repeat_; ++run )
+    {
+
+        // document and highlighter setup is not timed
+        QTextDocument document;
+        document.setPlainText( corpus );
+
+        TextHighlight highlight( &document );
+        highlight.setPatterns( documentClass.highlightPatternSet() );
+        highlight.setStyles( documentClass.highlightStyleTable() );
+        highlight.setHighlightEnabled( true );
+
+        // pattern locations
+        QElapsedTimer timer;
+        qint64 allocations( AllocationCounter::count() );
+        timer.start();
+
+        int activeId( -1 );
+        for( const auto& block:blocks )
+        { activeId = highlight.locationSet( block, activeId ).activeId().second; }
+
+        const qint64 locationSetTime( timer.nsecsElapsed() );
+        const qint64 locationSetAllocations( AllocationCounter::count() - allocations );
+
+        // full highlighting
+        allocations = AllocationCounter::count();
+        timer.restart();
+        highlight.rehighlight();
+
+        const qint64 highlightTime( timer.nsecsElapsed() );
+        const qint64 highlightAllocations( AllocationCounter::count() - allocations );
+
+        // blocks are now up to date, so that only formats are applied
+        timer.restart();
+        highlight.rehighlight();
+        const qint64 applyTime( timer.nsecsElapsed() );
+
+        // keep best times
+        if( run == 0 || locationSetTime < result.locationSetTime )
+        {
+            result.locationSetTime = locationSetTime;
+            result.locationSetAllocations = locationSetAllocations;
+        }
+
+        if( run == 0 || highlightTime < result.highlightTime )
+        {
+            result.highlightTime = highlightTime;
+            result.highlightAllocations = highlightAllocations;
+        }
+
+        if( run == 0 || applyTime < result.applyTime )
+        { result.applyTime = applyTime; }
+
+    }
+
+    result.peakMemory = _peakMemory();
+    return result;
+
+}
+
+//___________________________________________________________________________
+int HighlightBenchmark::checkWindows( const DocumentClass& documentClass, qint64& editTime ) const
+{
+
+    // corpus lines are joined into a single long line
+    auto text( _corpus( documentClass ) );
+    text.replace( QLatin1Char( '\n' ), QLatin1Char( ' ' ) );
+
+    QTextDocument document;
+    document.setPlainText( text );
+
+    TextHighlight highlight( &document );
+    highlight.setPatterns( documentClass.highlightPatternSet() );
+    highlight.setStyles( documentClass.highlightStyleTable() );
+    highlight.setHighlightEnabled( true );
+    highlight.rehighlight();
+
+    // long lines are highlighted over several event loop passes
+    const auto block( document.firstBlock() );
+    auto data( dynamic_cast<HighlightBlockData*>( block.userData() ) );
+    while( data && data->hasFlag( TextBlock::BlockModified ) )
+    {
+        QCoreApplication::processEvents();
+        data = dynamic_cast<HighlightBlockData*>( block.userData() );
+    }
+
+    if( !data ) return -1;
+
+    // count locations found in only one of the sets
+    const auto windowed( data->locations() );
+    const auto expected( TextHighlight::highlightLocationSet( *documentClass.highlightPatternSet(), text, -1 ) );
+    int matches( 0 );
+    for( const auto& location:windowed )
+    {
+        const auto iter( expected.find( location ) );
+        if( iter != expected.end() && *iter == location && iter->id() == location.id() && iter->length() == location.length() )
+        { ++matches; }
+    }
+
+    // typing a character highlights the line again, from the cached windows
+    // the edited window and the following ones are highlighted synchronously, within the time budget
+    QTextCursor cursor( block );
+    cursor.setPosition( block.position() + text.size()/2 );
+
+    QElapsedTimer timer;
+    timer.start();
+    cursor.insertText( QStringLiteral( "x" ) );
+    editTime = timer.nsecsElapsed();
+
+    return windowed.size() + expected.size() - 2*matches;
+
+}
+
+//___________________________________________________________________________
+DocumentClass HighlightBenchmark::syntheticClass( int patternCount )
+{
+
+    // generate xml, so that patterns are set up the same way as built-in classes
+    QDomDocument document;
+    auto top( document.createElement( Xml::DocumentClass ) );
+    top.setAttribute( Xml::Name, QStringLiteral( "synthetic-%1" ).arg( patternCount ) );
+    document.appendChild( top );
+
+    static const int styleCount = 8;
+    for( int index = 0; index < styleCount; ++index )
+    {
+        auto style( document.createElement( Xml::Style ) );
+        style.setAttribute( Xml::Name, QStringLiteral( "Style %1" ).arg( index ) );
+        style.setAttribute( Xml::Format, index%3 );
+        style.setAttribute( Xml::Color, QColor::fromHsv( index*360/styleCount, 255, 192 ).name() );
+        top.appendChild( style );
+    }
+
+    // mix pattern kinds found in built-in classes:
+    // keyword lists, keywords with suffixes, regular expressions and ranges
+    for( int index = 0; index < patternCount; ++index )
+    {
+
+        const bool isRange( index%4 == 3 );
+        auto pattern( document.createElement( isRange ? Xml::RangePattern:Xml::KeywordPattern ) );
+        pattern.setAttribute( Xml::Name, QStringLiteral( "Pattern %1" ).arg( index ) );
+        pattern.setAttribute( Xml::Parent, QString() );
+        pattern.setAttribute( Xml::Style, QStringLiteral( "Style %1" ).arg( index%styleCount ) );
+
+        if( isRange )
+        {
+
+            pattern.appendChild( document.createElement( Xml::Begin ) ).appendChild( document.createTextNode( QStringLiteral( "\\brange%1\\s*\\(" ).arg( index ) ) );
+            pattern.appendChild( document.createElement( Xml::End ) ).appendChild( document.createTextNode( QStringLiteral( "\\)" ) ) );
+
+        } else {
+
+            QString keyword;
+            switch( index%4 )
+            {
+                default:
+                case 0: keyword = QStringLiteral( "\\b(alpha%1|beta%1|gamma%1|delta%1|epsilon%1|zeta%1|eta%1|theta%1)\\b" ); break;
+                case 1: keyword = QStringLiteral( "\\b(type%1(int|float|double)(_t)?)\\b" ); break;
+                case 2: keyword = QStringLiteral( "\\bcall%1_\\w+(?=\\s*\\()" ); break;
+            }
+
+            pattern.appendChild( document.createElement( Xml::Keyword ) ).appendChild( document.createTextNode( keyword.arg( index ) ) );
+
+        }
+
+        top.appendChild( pattern );
+
+    }
+
+    return DocumentClass( top );
+
+}
+
+//___________________________________________________________________________
+void HighlightBenchmark::printHeader( QTextStream& out )
+{
+    out
+        << QStringLiteral( "%1 %2 %3 %4 %5 %6 %7 %8 %9" )
+        .arg( QStringLiteral( "class" ), -20 )
+        .arg( QStringLiteral( "patterns" ), 8 )
+        .arg( QStringLiteral( "MB" ), 6 )
+        .arg( QStringLiteral( "locations MB/s" ), 14 )
+        .arg( QStringLiteral( "ns/pattern/KB" ), 13 )
+        .arg( QStringLiteral( "highlight MB/s" ), 14 )
+        .arg( QStringLiteral( "apply MB/s" ), 10 )
+        .arg( QStringLiteral( "allocations/block" ), 17 )
+        .arg( QStringLiteral( "peak RSS MB" ), 11 )
+        << Qt::endl;
+}
+
+//___________________________________________________________________________
+void HighlightBenchmark::print( QTextStream& out, const Result& result )
+{
+
+    // size in MB, and throughput in MB/s
+    const double megabytes( double( result.characterCount )/(1<<20) );
+    auto throughput = [megabytes]( qint64 time ) { return time > 0 ? 1e9*megabytes/time:0; };
+
+    const double perPattern( result.patternCount > 0 && result.characterCount > 0 ?
+        double( result.locationSetTime )/result.patternCount/( double( result.characterCount )/1024 ):0 );
+
+    const double allocations( result.blockCount > 0 ?
+        double( result.locationSetAllocations + result.highlightAllocations )/result.blockCount:0 );
+
+    out
+        << QStringLiteral( "%1 %2 %3 %4 %5 %6 %7 %8 %9" )
+        .arg( result.name, -20 )
+        .arg( result.patternCount, 8 )
+        .arg( megabytes, 6, 'f', 2 )
+        .arg( throughput( result.locationSetTime ), 14, 'f', 2 )
+        .arg( perPattern, 13, 'f', 1 )
+        .arg( throughput( result.highlightTime ), 14, 'f', 2 )
+        .arg( throughput( result.applyTime ), 10, 'f', 2 )
+        .arg( allocations, 17, 'f', 1 )
+        .arg( double( result.peakMemory )/(1<<20), 11, 'f', 1 )
+        << Qt::endl;
+
+}
+
+//___________________________________________________________________________
+QString HighlightBenchmark::_corpus( const DocumentClass& documentClass ) const
+{
+
+    const auto iter( corpusFiles_.find( documentClass.name() ) );
+    if( iter == corpusFiles_.end() ) return _generateCorpus( documentClass );
+
+    // read files, and repeat them up to the requested size
+    QString contents;
+    for( const auto& filename:iter.value() )
+    {
+        QFile file( filename );
+        if( !file.open( QIODevice::ReadOnly ) ) continue;
+        contents += QString::fromUtf8( file.readAll() );
+        if( !contents.endsWith( QLatin1Char( '\n' ) ) ) contents += QLatin1Char( '\n' );
+    }
+
+    if( contents.isEmpty() ) return _generateCorpus( documentClass );
+
+    QString out( contents );
+    while( out.size() < size_ ) out += contents;
+    return out;
+
+}
+
+//___________________________________________________________________________
+QString HighlightBenchmark::_generateCorpus( const DocumentClass& documentClass ) const
+{
+
+    // snippets common to most languages: strings, comments, markup, variables and operators
+    static const QStringList snippets(
+    {
+        QStringLiteral( "\"some text\"" ),
+        QStringLiteral( "'c'" ),
+        QStringLiteral( "// end of line comment" ),
+        QStringLiteral( "# end of line comment" ),
+        QStringLiteral( "% end of line comment" ),
+        QStringLiteral( "/* comment */" ),
+        QStringLiteral( "<tag attribute=\"value\">" ),
+        QStringLiteral( "</tag>" ),
+        QStringLiteral( "<!-- comment -->" ),
+        QStringLiteral( "$variable" ),
+        QStringLiteral( "\\command{argument}" ),
+        QStringLiteral( "{" ),
+        QStringLiteral( "}" ),
+        QStringLiteral( "(" ),
+        QStringLiteral( ")" ),
+        QStringLiteral( ";" ),
+        QStringLiteral( "=" ),
+        QStringLiteral( "+" ),
+        QStringLiteral( "->" ),
+        QStringLiteral( "::" )
+    } );
+
+    auto keywords( _keywords( documentClass ) );
+    if( keywords.isEmpty() ) keywords.append( QStringLiteral( "keyword" ) );
+
+    // fixed seed, so that runs are comparable
+    std::mt19937 generator( 12345 );
+    auto random = [&generator]( int size ) { return std::uniform_int_distribution<int>( 0, size-1 )( generator ); };
+
+    QString out;
+    out.reserve( size_ + 256 );
+    bool inComment( false );
+    while( out.size() < size_ )
+    {
+
+        // indentation
+        out += QString( 4*random( 4 ), QLatin1Char( ' ' ) );
+
+        // multi-line comments
+        if( random( 50 ) == 0 )
+        {
+            out += inComment ? QStringLiteral( "*/" ):QStringLiteral( "/*" );
+            inComment = !inComment;
+        }
+
+        const int tokenCount( dense_ ? 8 + random( 12 ):2 + random( 10 ) );
+        for( int token = 0; token < tokenCount; ++token )
+        {
+
+            if( token ) out += QLatin1Char( ' ' );
+            const int category( random( 100 ) );
+            if( category < ( dense_ ? 70:25 ) ) out += keywords[random( keywords.size() )];
+            else if( category < 70 ) out += QStringLiteral( "identifier%1" ).arg( random( 1000 ) );
+            else if( category < 80 ) out += QString::number( random( 100000 ) );
+            else out += snippets[random( snippets.size() )];
+
+        }
+
+        out += QLatin1Char( '\n' );
+
+    }
+
+    return out;
+
+}
+
+//___________________________________________________________________________
+QStringList HighlightBenchmark::_keywords( const DocumentClass& documentClass )
+{
+
+    // escape sequences are removed first, so that \b or \s do not stick to words
+    static const QRegularExpression escapeRegExp( QStringLiteral( "\\\\." ) );
+    static const QRegularExpression wordRegExp( QStringLiteral( "[A-Za-z_][A-Za-z0-9_]+" ) );
+
+    QSet<QString> keywords;
+    for( const auto& pattern:documentClass.highlightPatterns() )
+    {
+        auto expression( pattern.keyword().pattern() );
+        expression.replace( escapeRegExp, QStringLiteral( " " ) );
+
+        auto iter( wordRegExp.globalMatch( expression ) );
+        while( iter.hasNext() )
+        { keywords.insert( iter.next().captured() ); }
+    }
+
+    auto out( keywords.values() );
+    std::sort( out.begin(), out.end() );
+    return out;
+
+}
+
+//___________________________________________________________________________
+void HighlightBenchmark::_resetPeakMemory()
+{
+    #if defined(Q_OS_LINUX)
+    // resets the VmHWM entry of /proc/self/status
+    QFile file( QStringLiteral( "/proc/self/clear_refs" ) );
+    if( file.open( QIODevice::WriteOnly ) ) file.write( "5" );
+    #endif
+}
+
+//___________________________________________________________________________
+qint64 HighlightBenchmark::_peakMemory()
+{
+
+    #if defined(Q_OS_LINUX)
+    QFile file( QStringLiteral( "/proc/self/status" ) );
+    if( file.open( QIODevice::ReadOnly ) )
+    {
+        const auto lines( file.readAll().split( '\n' ) );
+        for( const auto& line:lines )
+        {
+            if( !line.startsWith( "VmHWM:" ) ) continue;
+            return line.mid( 6 ).trimmed().split( ' ' ).front().toLongLong() << 10;
+        }
+    }
+    #endif
+
+    #if defined(Q_OS_UNIX)
+    struct rusage usage;
+    if( getrusage( RUSAGE_SELF, &usage ) == 0 )
+    {
+        #if defined(Q_OS_MACOS)
+        return usage.ru_maxrss;
+        #else
+        return qint64( usage.ru_maxrss ) << 10;
+        #endif
+    }
+    #endif
+
+    return 0;
+
+}
@@ -0,0 +1,158 @@
+#ifndef HighlightBenchmark_h
+#define HighlightBenchmark_h
+
+/******************************************************************************
+*
+* Copyright (C) 2002 Hugo PEREIRA <mailto: hugo.pereira@free.fr>
+*
+* This is free software; you can redistribute it and/or modify it under the
+* terms of the GNU General Public License as published by the Free Software
+* Foundation; either version 2 of the License, or (at your option) any later
+* version.
+*
+* This software is distributed in the hope that it will be useful, but WITHOUT
+* Any WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along with
+* this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*******************************************************************************/
+
+#include "DocumentClass.h"
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QTextStream>
+
+//* times syntax highlighting of a corpus, for a given document class
+/**
+corpora are either read from files, or generated from the document class keywords.
+For each class, three passes are timed:
+computing pattern locations with TextHighlight::locationSet,
+highlighting a full document with TextHighlight::highlightBlock,
+and highlighting it again from the stored locations, which only applies formats
+*/
+class HighlightBenchmark final
+{
+
+    public:
+
+    //* constructor
+    explicit HighlightBenchmark() = default;
+
+    //* benchmark result, for a given document class
+    class Result final
+    {
+
+        public:
+
+        //* document class name
+        QString name;
+
+        //* number of highlight patterns
+        int patternCount = 0;
+
+        //* number of characters
+        qint64 characterCount = 0;
+
+        //* number of blocks
+        int blockCount = 0;
+
+        //*@name timing, in nanoseconds
+        //@{
+        qint64 locationSetTime = 0;
+        qint64 highlightTime = 0;
+        qint64 applyTime = 0;
+        //@}
+
+        //*@name allocations
+        //@{
+        qint64 locationSetAllocations = 0;
+        qint64 highlightAllocations = 0;
+        //@}
+
+        //* peak resident memory, in bytes
+        qint64 peakMemory = 0;
+
+    };
+
+    //*@name modifiers
+    //@{
+
+    //* generated corpus size, in characters
+    void setSize( qint64 value )
+    { size_ = value; }
+
+    //* generate keyword dense lines
+    void setDense( bool value )
+    { dense_ = value; }
+
+    //* number of runs. The best time is kept
+    void setRepeat( int value )
+    { repeat_ = qMax( 1, value ); }
+
+    //* add corpus file for a given document class
+    void addCorpusFile( const QString& className, const QString& file )
+    { corpusFiles_[className].append( file ); }
+
+    //@}
+
+    //* run benchmark for given document class
+    Result run( const DocumentClass& ) const;
+
+    //* highlight the corpus joined into a single long line, window by window
+    /**
+    returns the number of locations that differ from highlighting the line at once, or -1 on failure.
+    Edit time is set to the time spent highlighting synchronously when typing a character in the middle of the line (ns)
+    */
+    int checkWindows( const DocumentClass&, qint64& editTime ) const;
+
+    //* synthetic document class with a given number of patterns
+    static DocumentClass syntheticClass( int patternCount );
+
+    //*@name output
+    //@{
+
+    //* print table header
+    static void printHeader( QTextStream& );
+
+    //* print result
+    static void print( QTextStream&, const Result& );
+
+    //@}
+
+    private:
+
+    //* corpus for a given document class
+    QString _corpus( const DocumentClass& ) const;
+
+    //* generate corpus from document class keywords
+    QString _generateCorpus( const DocumentClass& ) const;
+
+    //* words used in document class keyword patterns
+    static QStringList _keywords( const DocumentClass& );
+
+    //* reset peak resident memory, when supported
+    static void _resetPeakMemory();
+
+    //* peak resident memory, in bytes
+    static qint64 _peakMemory();
+
+    //* generated corpus size
+    qint64 size_ = 1<<20;
+
+    //* keyword dense corpus
+    bool dense_ = false;
+
+    //* number of runs
+    int repeat_ = 3;
+
+    //* corpus files, per document class name
+    QHash<QString, QStringList> corpusFiles_;
+
+};
+
+#endif
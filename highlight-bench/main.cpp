@@ -0,0 +1,157 @@
+/******************************************************************************
+*
+* Copyright (C) 2002 Hugo PEREIRA <mailto: hugo.pereira@free.fr>
+*
+* This is free software; you can redistribute it and/or modify it under the
+* terms of the GNU General Public License as published by the Free Software
+* Foundation; either version 2 of the License, or (at your option) any later
+* version.
+*
+* This software is distributed in the hope that it will be useful, but WITHOUT
+* Any WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along with
+* this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*******************************************************************************/
+
+#include "AllocationCounter.h"
+#include "DocumentClass.h"
+#include "DocumentClassManager.h"
+#include "File.h"
+#include "HighlightBenchmark.h"
+
+#include <QCommandLineParser>
+#include <QDir>
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QGuiApplication>
+#include <QTemporaryDir>
+#include <QTextStream>
+
+//__________________________________________
+//! main function
+int main (int argc, char *argv[])
+{
+
+    // no display is needed
+    if( qEnvironmentVariableIsEmpty( "QT_QPA_PLATFORM" ) )
+    { qputenv( "QT_QPA_PLATFORM", "offscreen" ); }
+
+    // resources
+    Q_INIT_RESOURCE( patterns );
+
+    // application
+    QGuiApplication application( argc, argv );
+    QGuiApplication::setApplicationName( QStringLiteral( "qedit-highlight-bench" ) );
+
+    // command line
+    QCommandLineParser parser;
+    parser.setApplicationDescription( QStringLiteral( "Times syntax highlighting for each document class" ) );
+    parser.addHelpOption();
+
+    const QCommandLineOption patternsOption( QStringLiteral( "patterns" ), QStringLiteral( "Read document classes from xml files in <directory> rather than built-in ones." ), QStringLiteral( "directory" ) );
+    const QCommandLineOption corpusOption( QStringLiteral( "corpus" ), QStringLiteral( "Read corpus files from <directory>, assigned to document classes by file name." ), QStringLiteral( "directory" ) );
+    const QCommandLineOption sizeOption( QStringLiteral( "size" ), QStringLiteral( "Corpus size, in MB." ), QStringLiteral( "size" ), QStringLiteral( "1" ) );
+    const QCommandLineOption denseOption( QStringLiteral( "dense" ), QStringLiteral( "Generate keyword dense lines." ) );
+    const QCommandLineOption repeatOption( QStringLiteral( "repeat" ), QStringLiteral( "Number of runs. The best time is kept." ), QStringLiteral( "count" ), QStringLiteral( "3" ) );
+    const QCommandLineOption classOption( QStringLiteral( "class" ), QStringLiteral( "Only benchmark document class <name>. Can be repeated." ), QStringLiteral( "name" ) );
+    const QCommandLineOption syntheticOption( QStringLiteral( "synthetic" ), QStringLiteral( "Also benchmark a synthetic class with <count> patterns. 0 disables it." ), QStringLiteral( "count" ), QStringLiteral( "100" ) );
+    const QCommandLineOption checkWindowsOption( QStringLiteral( "check-windows" ), QStringLiteral( "Check that long lines get the same locations when highlighted window by window." ) );
+    parser.addOptions( { patternsOption, corpusOption, sizeOption, denseOption, repeatOption, classOption, syntheticOption, checkWindowsOption } );
+    parser.process( application );
+
+    // document classes
+    const QDir patternDirectory( parser.isSet( patternsOption ) ? parser.value( patternsOption ):QStringLiteral( ":/patterns" ) );
+    const auto patternFiles( patternDirectory.entryInfoList( { QStringLiteral( "*.xml" ) }, QDir::Files, QDir::Name ) );
+
+    // read all pattern files, using cache file if not empty. Returns elapsed time (ns)
+    auto readClasses = [&patternFiles]( DocumentClassManager& manager, const File& cacheFile )
+    {
+        QElapsedTimer timer;
+        timer.start();
+
+        manager.setCacheFile( cacheFile );
+        for( const auto& fileInfo:patternFiles )
+        {
+            if( !manager.read( File( fileInfo.filePath() ) ) && cacheFile.isEmpty() )
+            { QTextStream( stderr ) << "qedit-highlight-bench: cannot read " << fileInfo.filePath() << ": " << manager.readError() << Qt::endl; }
+        }
+
+        manager.writeCache();
+        return timer.nsecsElapsed();
+    };
+
+    DocumentClassManager manager;
+    const qint64 xmlTime( readClasses( manager, File() ) );
+
+    // same from the binary cache, once filled
+    qint64 cacheTime( 0 );
+    QTemporaryDir cacheDirectory;
+    if( cacheDirectory.isValid() )
+    {
+        const File cacheFile( File( QStringLiteral( "classes.cache" ) ).addPath( File( cacheDirectory.path() ) ) );
+        DocumentClassManager first;
+        readClasses( first, cacheFile );
+
+        DocumentClassManager second;
+        cacheTime = readClasses( second, cacheFile );
+    }
+
+    // benchmark
+    HighlightBenchmark benchmark;
+    benchmark.setSize( qint64( parser.value( sizeOption ).toDouble()*(1<<20) ) );
+    benchmark.setDense( parser.isSet( denseOption ) );
+    benchmark.setRepeat( parser.value( repeatOption ).toInt() );
+
+    if( parser.isSet( corpusOption ) )
+    {
+        QDirIterator iterator( parser.value( corpusOption ), QDir::Files, QDirIterator::Subdirectories );
+        while( iterator.hasNext() )
+        {
+            const File file( iterator.next() );
+            const auto documentClass( manager.find( file ) );
+            if( !documentClass.name().isEmpty() ) benchmark.addCorpusFile( documentClass.name(), file );
+        }
+    }
+
+    // classes. They are fully parsed on first access
+    DocumentClassManager::List documentClasses;
+    for( const auto& documentClass:manager.classes() )
+    { documentClasses.append( manager.get( documentClass.name() ) ); }
+
+    const int syntheticCount( parser.value( syntheticOption ).toInt() );
+    if( syntheticCount > 0 ) documentClasses.append( HighlightBenchmark::syntheticClass( syntheticCount ) );
+
+    const auto names( parser.values( classOption ) );
+    QTextStream out( stdout );
+    out << "document classes: " << patternFiles.size() << " files, loaded in " << xmlTime/1000000.0 << " ms from xml, " << cacheTime/1000000.0 << " ms from cache" << Qt::endl << Qt::endl;
+    HighlightBenchmark::printHeader( out );
+    for( const auto& documentClass:documentClasses )
+    {
+        if( names.isEmpty() || names.contains( documentClass.name() ) )
+        { HighlightBenchmark::print( out, benchmark.run( documentClass ) ); }
+    }
+
+    if( parser.isSet( checkWindowsOption ) )
+    {
+        out << Qt::endl;
+        for( const auto& documentClass:documentClasses )
+        {
+            if( names.isEmpty() || names.contains( documentClass.name() ) )
+            {
+                qint64 editTime( 0 );
+                const int mismatches( benchmark.checkWindows( documentClass, editTime ) );
+                out << "windows " << documentClass.name() << ": " << mismatches << " mismatching locations, edit: " << editTime/1000000.0 << " ms" << Qt::endl;
+            }
+        }
+    }
+
+    if( !AllocationCounter::countsMalloc() )
+    { out << "note: only operator new allocations are counted on this platform" << Qt::endl; }
+
+    return 0;
+
+}
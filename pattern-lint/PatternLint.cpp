@@ -0,0 +1,111 @@
+/******************************************************************************
+*
+* Copyright (C) 2002 Hugo PEREIRA <mailto: hugo.pereira@free.fr>
+*
+* This is free software; you can redistribute it and/or modify it under the
+* terms of the GNU General Public License as published by the Free Software
+* Foundation; either version 2 of the License, or (at your option) any later
+* version.
+*
+* This software is distributed in the hope that it will be useful, but WITHOUT
+* Any WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along with
+* this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*******************************************************************************/
+
+#include "PatternLint.h"
+#include "HighlightProfiler.h"
+#include "TextHighlight.h"
+
+#include <QFile>
+
+//___________________________________________________________________________
+PatternLint::ResultList PatternLint::run( const DocumentClass& documentClass ) const
+{
+
+    const auto& patternSet( *documentClass.highlightPatternSet() );
+    for( const auto& pattern:patternSet.patterns() )
+    { pattern.resetStatistics(); }
+
+    // profiling processes merged keyword patterns one by one, and counts discarded locations
+    HighlightProfiler::setEnabled( true );
+    for( const auto& file:corpusFiles_.value( documentClass.name() ) )
+    {
+
+        QFile in( file );
+        if( !in.open( QIODevice::ReadOnly ) ) continue;
+
+        // the active pattern is propagated from one block to the next, as when highlighting a document
+        int activeId( -1 );
+        for( const auto& line:QString::fromUtf8( in.readAll() ).split( QLatin1Char( '\n' ) ) )
+        { activeId = TextHighlight::highlightLocationSet( patternSet, line, activeId ).activeId().second; }
+
+    }
+
+    HighlightProfiler::setEnabled( false );
+
+    // collect statistics
+    ResultList out;
+    for( const auto& pattern:patternSet.patterns() )
+    {
+        Result result;
+        result.className = documentClass.name();
+        result.name = pattern.name();
+        result.invocations = pattern.profile().invocations();
+        result.matches = pattern.profile().matches();
+        result.overlapCount = pattern.overlapCount();
+        result.time = pattern.profile().time();
+        result.worstTime = pattern.profile().worstTime();
+        result.overBudgetCount = pattern.overBudgetCount();
+        result.backtrackingProne = pattern.isBacktrackingProne();
+        out.append( result );
+    }
+
+    return out;
+
+}
+
+//___________________________________________________________________________
+void PatternLint::printHeader( QTextStream& out )
+{
+    out
+        << QStringLiteral( "%1 %2 %3 %4 %5 %6 %7 %8 %9" )
+        .arg( QStringLiteral( "class" ), -20 )
+        .arg( QStringLiteral( "pattern" ), -24 )
+        .arg( QStringLiteral( "blocks" ), 10 )
+        .arg( QStringLiteral( "matches" ), 10 )
+        .arg( QStringLiteral( "discarded" ), 10 )
+        .arg( QStringLiteral( "time ms" ), 10 )
+        .arg( QStringLiteral( "worst us" ), 10 )
+        .arg( QStringLiteral( "over budget" ), 11 )
+        .arg( QStringLiteral( "status" ) )
+        << Qt::endl;
+}
+
+//___________________________________________________________________________
+void PatternLint::print( QTextStream& out, const Result& result ) const
+{
+
+    QStringList status;
+    if( isSlow( result ) ) status.append( QStringLiteral( "slow" ) );
+    if( result.matches == 0 ) status.append( QStringLiteral( "never matches" ) );
+    if( result.backtrackingProne ) status.append( QStringLiteral( "backtracking prone" ) );
+
+    out
+        << QStringLiteral( "%1 %2 %3 %4 %5 %6 %7 %8 %9" )
+        .arg( result.className, -20 )
+        .arg( result.name, -24 )
+        .arg( result.invocations, 10 )
+        .arg( result.matches, 10 )
+        .arg( result.overlapCount, 10 )
+        .arg( double( result.time )/1e6, 10, 'f', 2 )
+        .arg( double( result.worstTime )/1e3, 10, 'f', 1 )
+        .arg( result.overBudgetCount, 11 )
+        .arg( status.join( QStringLiteral( ", " ) ) )
+        << Qt::endl;
+
+}
@@ -0,0 +1,127 @@
+#ifndef PatternLint_h
+#define PatternLint_h
+
+/******************************************************************************
+*
+* Copyright (C) 2002 Hugo PEREIRA <mailto: hugo.pereira@free.fr>
+*
+* This is free software; you can redistribute it and/or modify it under the
+* terms of the GNU General Public License as published by the Free Software
+* Foundation; either version 2 of the License, or (at your option) any later
+* version.
+*
+* This software is distributed in the hope that it will be useful, but WITHOUT
+* Any WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along with
+* this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*******************************************************************************/
+
+#include "DocumentClass.h"
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QTextStream>
+#include <QVector>
+
+//* runs the highlight patterns of document classes over a corpus
+/**
+patterns are run one by one, with profiling enabled, so that time,
+number of matches and number of locations discarded because of overlaps
+are reported per pattern
+*/
+class PatternLint final
+{
+
+    public:
+
+    //* constructor
+    explicit PatternLint() = default;
+
+    //* result, for a given highlight pattern
+    class Result final
+    {
+
+        public:
+
+        //* document class name
+        QString className;
+
+        //* pattern name
+        QString name;
+
+        //* number of processed blocks
+        qint64 invocations = 0;
+
+        //* number of matches
+        qint64 matches = 0;
+
+        //* number of locations discarded because of overlaps
+        int overlapCount = 0;
+
+        //*@name timing, in nanoseconds
+        //@{
+        qint64 time = 0;
+        qint64 worstTime = 0;
+        //@}
+
+        //* number of blocks for which the budget was exceeded
+        int overBudgetCount = 0;
+
+        //* regular expressions prone to catastrophic backtracking
+        bool backtrackingProne = false;
+
+    };
+
+    using ResultList = QVector<Result>;
+
+    //*@name modifiers
+    //@{
+
+    //* maximum time for a single block, in nanoseconds
+    void setMaxTime( qint64 value )
+    { maxTime_ = value; }
+
+    //* add corpus file for a given document class
+    void addCorpusFile( const QString& className, const QString& file )
+    { corpusFiles_[className].append( file ); }
+
+    //@}
+
+    //* number of corpus files for a given document class
+    int corpusSize( const QString& className ) const
+    { return corpusFiles_.value( className ).size(); }
+
+    //* run all patterns of a document class over its corpus
+    ResultList run( const DocumentClass& ) const;
+
+    //* true if pattern exceeded the maximum time, or its budget
+    bool isSlow( const Result& result ) const
+    { return result.overBudgetCount > 0 || result.worstTime > maxTime_; }
+
+    //*@name output
+    //@{
+
+    //* print table header
+    static void printHeader( QTextStream& );
+
+    //* print result
+    void print( QTextStream&, const Result& ) const;
+
+    //@}
+
+    private:
+
+    //* maximum time for a single block
+    qint64 maxTime_ = 1000000;
+
+    //* corpus files, per document class name
+    QHash<QString, QStringList> corpusFiles_;
+
+};
+
+#endif
@@ -0,0 +1,142 @@
+/******************************************************************************
+*
+* Copyright (C) 2002 Hugo PEREIRA <mailto: hugo.pereira@free.fr>
+*
+* This is free software; you can redistribute it and/or modify it under the
+* terms of the GNU General Public License as published by the Free Software
+* Foundation; either version 2 of the License, or (at your option) any later
+* version.
+*
+* This software is distributed in the hope that it will be useful, but WITHOUT
+* Any WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along with
+* this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*******************************************************************************/
+
+#include "DocumentClass.h"
+#include "DocumentClassManager.h"
+#include "File.h"
+#include "PatternLint.h"
+
+#include <QCommandLineParser>
+#include <QDir>
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QGuiApplication>
+#include <QTextStream>
+
+//__________________________________________
+//! main function
+int main (int argc, char *argv[])
+{
+
+    // no display is needed
+    if( qEnvironmentVariableIsEmpty( "QT_QPA_PLATFORM" ) )
+    { qputenv( "QT_QPA_PLATFORM", "offscreen" ); }
+
+    // application
+    QGuiApplication application( argc, argv );
+    QGuiApplication::setApplicationName( QStringLiteral( "qedit-pattern-lint" ) );
+
+    // command line
+    QCommandLineParser parser;
+    parser.setApplicationDescription( QStringLiteral( "Runs the highlight patterns of a pattern file over a corpus. Exits with non zero status if patterns are invalid or slow." ) );
+    parser.addHelpOption();
+    parser.addPositionalArgument( QStringLiteral( "file" ), QStringLiteral( "Pattern file." ) );
+    parser.addPositionalArgument( QStringLiteral( "corpus" ), QStringLiteral( "Corpus files or directories, assigned to document classes by file name." ), QStringLiteral( "[corpus...]" ) );
+
+    const QCommandLineOption maxTimeOption( QStringLiteral( "max-time" ), QStringLiteral( "Maximum time for a pattern on a single line, in microseconds." ), QStringLiteral( "time" ), QStringLiteral( "1000" ) );
+    const QCommandLineOption classOption( QStringLiteral( "class" ), QStringLiteral( "Assign corpus files that match no document class to class <name>." ), QStringLiteral( "name" ) );
+    const QCommandLineOption strictOption( QStringLiteral( "strict" ), QStringLiteral( "Also fail on patterns that never match or are prone to catastrophic backtracking, and on classes with no corpus." ) );
+    parser.addOptions( { maxTimeOption, classOption, strictOption } );
+    parser.process( application );
+
+    const auto arguments( parser.positionalArguments() );
+    if( arguments.isEmpty() ) parser.showHelp( 1 );
+
+    QTextStream out( stdout );
+    QTextStream err( stderr );
+
+    // document classes
+    DocumentClassManager manager;
+    const File patternFile( arguments.front() );
+    if( !manager.read( patternFile ) )
+    {
+        err << "qedit-pattern-lint: cannot read " << patternFile << ( manager.readError().isEmpty() ? QString():QStringLiteral( ": " ) + manager.readError() ) << Qt::endl;
+        return 1;
+    }
+
+    // classes are fully parsed on first access
+    DocumentClassManager::List documentClasses;
+    for( const auto& documentClass:manager.classes() )
+    { documentClasses.append( manager.get( documentClass.name() ) ); }
+
+    if( documentClasses.isEmpty() )
+    {
+        err << "qedit-pattern-lint: no document class in " << patternFile << Qt::endl;
+        return 1;
+    }
+
+    // corpus
+    PatternLint lint;
+    lint.setMaxTime( parser.value( maxTimeOption ).toLongLong()*1000 );
+    for( const auto& argument:arguments.mid( 1 ) )
+    {
+
+        QStringList files;
+        if( QFileInfo( argument ).isDir() )
+        {
+            QDirIterator iterator( argument, QDir::Files, QDirIterator::Subdirectories );
+            while( iterator.hasNext() ) files.append( iterator.next() );
+        } else files.append( argument );
+
+        for( const auto& file:files )
+        {
+            auto className( manager.find( File( file ) ).name() );
+            if( className.isEmpty() ) className = parser.value( classOption );
+            if( className.isEmpty() && documentClasses.size() == 1 ) className = documentClasses.front().name();
+
+            if( className.isEmpty() ) err << "qedit-pattern-lint: no document class for " << file << Qt::endl;
+            else lint.addCorpusFile( className, file );
+        }
+
+    }
+
+    // check
+    const bool strict( parser.isSet( strictOption ) );
+    int errors( 0 );
+
+    PatternLint::printHeader( out );
+    for( const auto& documentClass:documentClasses )
+    {
+
+        // parsing errors
+        for( const auto& warning:documentClass.warnings() )
+        {
+            err << "qedit-pattern-lint: " << documentClass.name() << ": " << warning << Qt::endl;
+            ++errors;
+        }
+
+        if( lint.corpusSize( documentClass.name() ) == 0 )
+        {
+            err << "qedit-pattern-lint: " << documentClass.name() << ": no corpus file" << Qt::endl;
+            if( strict ) ++errors;
+            continue;
+        }
+
+        for( const auto& result:lint.run( documentClass ) )
+        {
+            lint.print( out, result );
+            if( lint.isSlow( result ) ) ++errors;
+            else if( strict && ( result.matches == 0 || result.backtrackingProne ) ) ++errors;
+        }
+
+    }
+
+    return errors > 0 ? 1:0;
+
+}
@@ -22,6 +22,8 @@
 #include "DocumentClassManagerDialog.h"
 #include "FileCheck.h"
 #include "FileCheckDialog.h"
+#include "HighlightCache.h"
+#include "HighlightProfileDialog.h"
 #include "IconEngine.h"
 #include "IconNames.h"
 #include "InformationDialog.h"
@@ -41,6 +43,7 @@
 #include "SpellInterface.h"
 #endif
 
+#include <QElapsedTimer>
 #include <QMessageBox>
 
 //____________________________________________
@@ -119,6 +122,7 @@ bool Application::realizeWidget()
 
     // class manager
     classManager_.reset(new DocumentClassManager);
+    connect( &patternFileWatcher_, &QFileSystemWatcher::fileChanged, this, &Application::_patternFileChanged );
 
     // autosave
     autosave_.reset( new AutoSave );
@@ -186,18 +190,28 @@ void Application::_updateDocumentClasses()
 {
     Debug::Throw( QStringLiteral("Application::_updateDocumentClasses.\n") );
 
+    QElapsedTimer timer;
+    timer.start();
+
     // clear document classes
     classManager_->clear();
+    classManager_->setCacheFile( File( XmlOptions::get().raw( QStringLiteral("DOCUMENT_CLASS_CACHE_FILE") ) ) );
 
     // load files from options
     QString buffer;
     QTextStream what( &buffer );
 
     // read user specific patterns
+    // they are monitored, and reloaded when modified
+    if( !patternFileWatcher_.files().isEmpty() ) patternFileWatcher_.removePaths( patternFileWatcher_.files() );
+    modifiedPatternFiles_.clear();
+    patternFileTimer_.stop();
     for( const auto& option:XmlOptions::get().specialOptions( QStringLiteral("PATTERN_FILENAME") ) )
     {
-        classManager_->read( File( option.raw() ) );
+        const File file( option.raw() );
+        classManager_->read( file );
         what << classManager_->readError();
+        if( file.exists() ) patternFileWatcher_.addPath( file );
     }
 
     // read build-in patterns
@@ -207,6 +221,10 @@ void Application::_updateDocumentClasses()
         what << classManager_->readError();
     }
 
+    // store parsed files
+    classManager_->writeCache();
+    Debug::Throw() << "Application::_updateDocumentClasses - classes: " << classManager_->classes().size() << " elapsed: " << timer.elapsed() << "ms" << Qt::endl;
+
     if( !buffer.isEmpty() ) InformationDialog( 0, buffer ).exec();
 
     // load document classes icons into iconEngine cache, if any
@@ -244,6 +262,53 @@ void Application::_spellCheckConfiguration()
     #endif
 }
 
+//____________________________________________________________
+void Application::_patternFileChanged( const QString& file )
+{
+    Debug::Throw() << "Application::_patternFileChanged - file: " << file << Qt::endl;
+    modifiedPatternFiles_.insert( file );
+    patternFileTimer_.start( 200, this );
+}
+
+//____________________________________________________________
+void Application::_reloadPatternFiles()
+{
+    Debug::Throw( QStringLiteral("Application::_reloadPatternFiles.\n") );
+
+    QStringList modified;
+    const auto files( modifiedPatternFiles_ );
+    modifiedPatternFiles_.clear();
+    for( const auto& file:files )
+    {
+
+        // files replaced when saved are no longer monitored
+        if( File( file ).exists() && !patternFileWatcher_.files().contains( file ) )
+        { patternFileWatcher_.addPath( file ); }
+
+        if( classManager_->reload( File( file ), modified ) ) continue;
+
+        // keep current classes until file is fixed
+        if( !classManager_->readError().isEmpty() )
+        {
+            Debug::Throw(0) << "Application::_reloadPatternFiles - " << classManager_->readError() << Qt::endl;
+            continue;
+        }
+
+        // classes were added or removed. Read everything again
+        _updateDocumentClasses();
+        return;
+
+    }
+
+    // other pattern files were not read again, and are kept in the cache
+    classManager_->writeCache( false );
+
+    // only displays that use modified classes are updated
+    for( const auto& name:modified )
+    { emit documentClassModified( name ); }
+
+}
+
 //_______________________________________________
 void Application::_documentClassesConfiguration()
 {
@@ -353,6 +418,24 @@ void Application::_showMonitoredFiles()
     dialog.exec();
 }
 
+//_____________________________________________
+void Application::_showHighlightProfile()
+{
+    Debug::Throw( QStringLiteral("Application::_showHighlightProfile.\n") );
+
+    // dialog is not modal, so that profiling goes on while editing
+    if( !highlightProfileDialog_ )
+    {
+        highlightProfileDialog_ = new HighlightProfileDialog;
+        highlightProfileDialog_->setAttribute( Qt::WA_DeleteOnClose );
+    }
+
+    highlightProfileDialog_->centerOnWidget( qApp->activeWindow() );
+    highlightProfileDialog_->show();
+    highlightProfileDialog_->raise();
+    highlightProfileDialog_->activateWindow();
+}
+
 //_______________________________________________
 void Application::_exit()
 {
@@ -384,7 +467,14 @@ void Application::timerEvent( QTimerEvent* event )
     {
         startupTimer_.stop();
         windowServer_->readFilesFromArguments( commandLineParser( _arguments() ) );
-        connect( qApp, &QGuiApplication::lastWindowClosed, this, &Application::lastWindowClose, Qt::UniqueConnection );    } else return QObject::timerEvent( event );
+        connect( qApp, &QGuiApplication::lastWindowClosed, this, &Application::lastWindowClose, Qt::UniqueConnection );
+
+    } else if( event->timerId() == patternFileTimer_.timerId() ) {
+
+        patternFileTimer_.stop();
+        _reloadPatternFiles();
+
+    } else return QObject::timerEvent( event );
 }
 
 //_________________________________________________
@@ -403,6 +493,10 @@ void Application::_updateConfiguration()
     static_cast<XmlFileList*>(sessionFiles_.get())->setDBFile(db_file);
     static_cast<XmlFileList*>(lastSessionFiles_.get())->setDBFile(db_file);
     recentFiles_->setMaxSize( XmlOptions::get().get<int>( QStringLiteral("DB_SIZE") ) );
+
+    // highlight cache is stored next to the recent files
+    HighlightCache::setPath( XmlOptions::get().raw( QStringLiteral("HIGHLIGHT_CACHE_PATH") ) );
+    HighlightCache::setMaxSize( qint64( XmlOptions::get().get<int>( QStringLiteral("HIGHLIGHT_CACHE_SIZE") ) ) << 20 );
 }
 
 //___________________________________________________________
@@ -446,4 +540,9 @@ void Application::_installActions()
     monitoredFilesAction_ = new QAction( tr( "Show Monitored Files" ), this );
     monitoredFilesAction_->setToolTip( tr( "Show monitored files" ) );
     connect( monitoredFilesAction_, &QAction::triggered, this, &Application::_showMonitoredFiles );
+
+    // highlighting profile
+    highlightProfileAction_ = new QAction( tr( "Show Highlighting Profile" ), this );
+    highlightProfileAction_->setToolTip( tr( "Show time spent in each highlight pattern" ) );
+    connect( highlightProfileAction_, &QAction::triggered, this, &Application::_showHighlightProfile );
 }
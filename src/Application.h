@@ -31,6 +31,9 @@
 #include "IconEngine.h"
 
 #include <QBasicTimer>
+#include <QFileSystemWatcher>
+#include <QPointer>
+#include <QSet>
 #include <QTimerEvent>
 
 #include <memory>
@@ -39,6 +42,7 @@ class AutoSave;
 class DocumentClassManager;
 class FileCheck;
 class FileList;
+class HighlightProfileDialog;
 class WindowServer;
 class Sync;
 
@@ -115,6 +119,10 @@ class Application: public BaseApplication, private Base::Counter<Application>
     QAction& monitoredFilesAction() const
     { return *monitoredFilesAction_; }
 
+    //* highlighting profile
+    QAction& highlightProfileAction() const
+    { return *highlightProfileAction_; }
+
 
     //@}
 
@@ -152,6 +160,9 @@ class Application: public BaseApplication, private Base::Counter<Application>
     //* document classes have been modified
     void documentClassesChanged();
 
+    //* a single document class has been reloaded
+    void documentClassModified( const QString& );
+
     protected:
 
     //* configuration
@@ -179,6 +190,12 @@ class Application: public BaseApplication, private Base::Counter<Application>
     //* document classes configuration
     void _documentClassesConfiguration();
 
+    //* user pattern file modified
+    void _patternFileChanged( const QString& );
+
+    //* reload modified user pattern files
+    void _reloadPatternFiles();
+
     //* save session
     void _saveSession();
 
@@ -203,6 +220,9 @@ class Application: public BaseApplication, private Base::Counter<Application>
     //* monitored files
     void _showMonitoredFiles();
 
+    //* highlighting profile
+    void _showHighlightProfile();
+
     //* exit safely
     void _exit();
 
@@ -240,6 +260,20 @@ class Application: public BaseApplication, private Base::Counter<Application>
     */
     QBasicTimer startupTimer_;
 
+    //*@name user pattern files monitoring
+    //@{
+
+    //* watcher
+    QFileSystemWatcher patternFileWatcher_;
+
+    //* modified files
+    QSet<QString> modifiedPatternFiles_;
+
+    //* delay reloading, since files are often written in several steps
+    QBasicTimer patternFileTimer_;
+
+    //@}
+
     //*@name actions
     //@{
 
@@ -267,6 +301,12 @@ class Application: public BaseApplication, private Base::Counter<Application>
     //* show monitored files
     QAction* monitoredFilesAction_ = nullptr;
 
+    //* highlighting profile
+    QAction* highlightProfileAction_ = nullptr;
+
+    //* highlighting profile dialog
+    QPointer<HighlightProfileDialog> highlightProfileDialog_;
+
     //@}
 
 };
@@ -71,6 +71,44 @@ ConfigurationDialog::ConfigurationDialog( QWidget* parent ):
     checkbox->setToolTip( tr( "Turn on/off syntax highlighting" ) );
     addOptionWidget( checkbox );
 
+    box->layout()->addWidget( checkbox = new OptionCheckBox( tr( "Highlight syntax in background" ), box, QStringLiteral("HIGHLIGHT_ASYNCHRONOUS") ) );
+    checkbox->setToolTip( tr( "Compute syntax highlighting of large documents in a separate thread, starting from visible text" ) );
+    addOptionWidget( checkbox );
+
+    {
+        QHBoxLayout* hLayout = new QHBoxLayout;
+        QtUtil::setMargin(hLayout, 0);
+        box->layout()->addItem( hLayout );
+
+        hLayout->addWidget( label = new QLabel( tr( "Only highlight visible text for documents larger than: " ), box ) );
+        hLayout->addWidget( spinbox = new OptionSpinBox( box, QStringLiteral("HIGHLIGHT_LAZY_SIZE") ) );
+        spinbox->setSuffix( tr( " MB" ) );
+        spinbox->setSpecialValueText( tr( "Never" ) );
+        spinbox->setMinimum( 0 );
+        spinbox->setMaximum( 1024 );
+        spinbox->setToolTip( tr( "Document size above which only text close to the visible area is highlighted" ) );
+        hLayout->addStretch( 1 );
+        label->setBuddy( spinbox );
+        addOptionWidget( spinbox );
+    }
+
+    {
+        QHBoxLayout* hLayout = new QHBoxLayout;
+        QtUtil::setMargin(hLayout, 0);
+        box->layout()->addItem( hLayout );
+
+        hLayout->addWidget( label = new QLabel( tr( "Syntax highlighting cache size: " ), box ) );
+        hLayout->addWidget( spinbox = new OptionSpinBox( box, QStringLiteral("HIGHLIGHT_CACHE_SIZE") ) );
+        spinbox->setSuffix( tr( " MB" ) );
+        spinbox->setSpecialValueText( tr( "Disabled" ) );
+        spinbox->setMinimum( 0 );
+        spinbox->setMaximum( 4096 );
+        spinbox->setToolTip( tr( "Maximum disk space used to store syntax highlighting of large documents, so that it is not computed again when they are reopened" ) );
+        hLayout->addStretch( 1 );
+        label->setBuddy( spinbox );
+        addOptionWidget( spinbox );
+    }
+
     box->layout()->addWidget( checkbox = new OptionCheckBox( tr( "Highlight parenthesis" ), box, QStringLiteral("TEXT_PARENTHESIS") ) );
     checkbox->setToolTip( tr( "Turn on/off highlighting of oppening/closing parenthesis" ) );
     addOptionWidget( checkbox );
@@ -78,6 +78,9 @@ void installDefaultOptions()
     XmlOptions::get().set<bool>( QStringLiteral("SHOW_BLOCK_DELIMITERS"), true );
     XmlOptions::get().set<bool>( QStringLiteral("TEXT_INDENT"), true );
     XmlOptions::get().set<bool>( QStringLiteral("TEXT_HIGHLIGHT"), true );
+    XmlOptions::get().set<bool>( QStringLiteral("HIGHLIGHT_ASYNCHRONOUS"), true );
+    XmlOptions::get().set<int>( QStringLiteral("HIGHLIGHT_LAZY_SIZE"), 16 );
+    XmlOptions::get().set<int>( QStringLiteral("HIGHLIGHT_CACHE_SIZE"), 64 );
     XmlOptions::get().set<bool>( QStringLiteral("TEXT_PARENTHESIS"), true );
     XmlOptions::get().set<bool>( QStringLiteral("WRAP_FROM_CLASS"), true );
     XmlOptions::get().set<bool>( QStringLiteral("EMULATE_TABS_FROM_CLASS"), true );
@@ -143,6 +146,12 @@ void installDefaultOptions()
     // resource file
     XmlOptions::get().set( QStringLiteral("RC_FILE"), Option( File("qeditrc").addPath(Util::config()), Option::Flag::None ) );
 
+    // parsed document classes
+    XmlOptions::get().set( QStringLiteral("DOCUMENT_CLASS_CACHE_FILE"), Option( File("qedit-classes.cache").addPath(Util::config()), Option::Flag::None ) );
+
+    // highlight cache
+    XmlOptions::get().setRaw( QStringLiteral("HIGHLIGHT_CACHE_PATH"), File("highlight-cache").addPath(Util::config()) );
+
     XmlOptions::get().setAutoDefault( false );
 
 };
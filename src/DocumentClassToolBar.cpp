@@ -70,7 +70,7 @@ void DocumentClassToolBar::_update()
     _comboBox().clear();
 
     // add all document classes
-    auto manager( Base::Singleton::get().application<Application>()->classManager() );
+    const auto& manager( Base::Singleton::get().application<Application>()->classManager() );
     auto classes( manager.classes() );
     for( const auto& documentClass:classes )
     { _comboBox().addItem( documentClass.name() ); }
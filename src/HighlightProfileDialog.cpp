@@ -0,0 +1,178 @@
+/******************************************************************************
+*
+* Copyright (C) 2002 Hugo PEREIRA <mailto: hugo.pereira@free.fr>
+*
+* This is free software; you can redistribute it and/or modify it under the
+* terms of the GNU General Public License as published by the Free Software
+* Foundation; either version 2 of the License, or (at your option) any later
+* version.
+*
+* This software is distributed in the hope that it will be useful, but WITHOUT
+* Any WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along with
+* this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*******************************************************************************/
+
+#include "HighlightProfileDialog.h"
+#include "Application.h"
+#include "Debug.h"
+#include "DocumentClassManager.h"
+#include "FileDialog.h"
+#include "HighlightProfiler.h"
+#include "IconEngine.h"
+#include "IconNames.h"
+#include "InformationDialog.h"
+#include "QtUtil.h"
+#include "Singleton.h"
+#include "TreeView.h"
+
+#include <QCheckBox>
+#include <QFile>
+#include <QLayout>
+#include <QPushButton>
+#include <QTextStream>
+
+//________________________________________________________
+HighlightProfileDialog::HighlightProfileDialog( QWidget* parent ):
+    Dialog( parent, CloseButton ),
+    Counter( QStringLiteral("HighlightProfileDialog") )
+{
+    Debug::Throw( QStringLiteral("HighlightProfileDialog::HighlightProfileDialog.\n") );
+    setWindowTitle( tr( "Highlighting Profile" ) );
+    setOptionName( QStringLiteral("HIGHLIGHT_PROFILE_DIALOG") );
+
+    // enable checkbox
+    mainLayout().addWidget( enableCheckBox_ = new QCheckBox( tr( "Profile syntax highlighting" ), this ) );
+    enableCheckBox_->setToolTip( tr( "Measure time spent in each highlight pattern. This slows down highlighting slightly" ) );
+    enableCheckBox_->setChecked( HighlightProfiler::isEnabled() );
+    connect( enableCheckBox_, &QAbstractButton::toggled, this, &HighlightProfileDialog::_setEnabled );
+
+    // list
+    mainLayout().addWidget( list_ = new TreeView( this ) );
+    list_->setModel( &model_ );
+    list_->setSelectionMode( QAbstractItemView::NoSelection );
+    list_->setOptionName( QStringLiteral("HIGHLIGHT_PROFILE_LIST") );
+
+    // buttons
+    QPushButton* button;
+    buttonLayout().insertWidget( 0, button = new QPushButton( IconEngine::get( IconNames::SaveAs ), tr( "Save As..." ), this ) );
+    button->setToolTip( tr( "Save profile to file" ) );
+    connect( button, &QAbstractButton::clicked, this, &HighlightProfileDialog::_save );
+
+    buttonLayout().insertWidget( 0, button = new QPushButton( tr( "Reset" ), this ) );
+    button->setToolTip( tr( "Reset all counters" ) );
+    connect( button, &QAbstractButton::clicked, this, &HighlightProfileDialog::_reset );
+
+    _update();
+    list_->resizeColumns();
+
+}
+
+//________________________________________________________
+void HighlightProfileDialog::showEvent( QShowEvent* event )
+{
+    _update();
+    timer_.start( updateInterval, this );
+    Dialog::showEvent( event );
+}
+
+//________________________________________________________
+void HighlightProfileDialog::hideEvent( QHideEvent* event )
+{
+    timer_.stop();
+    Dialog::hideEvent( event );
+}
+
+//________________________________________________________
+void HighlightProfileDialog::timerEvent( QTimerEvent* event )
+{
+    if( event->timerId() == timer_.timerId() )
+    {
+
+        if( HighlightProfiler::isEnabled() ) _update();
+
+    } else return Dialog::timerEvent( event );
+}
+
+//________________________________________________________
+void HighlightProfileDialog::_update()
+{
+
+    HighlightProfileModel::List profiles;
+    profiles.append( HighlightPatternProfile( tr( "All" ), tr( "Blocks" ), HighlightProfiler::blockCounters() ) );
+
+    for( const auto& documentClass:Base::Singleton::get().application<Application>()->classManager().classes() )
+    {
+        for( const auto& pattern:documentClass.highlightPatterns() )
+        {
+            if( pattern.profile().invocations() > 0 || pattern.overBudgetCount() > 0 )
+            { profiles.append( HighlightPatternProfile( documentClass.name(), pattern.name(), pattern.profile(), pattern.filterSkipCount(), pattern.overBudgetCount() ) ); }
+        }
+    }
+
+    model_.set( profiles );
+
+}
+
+//________________________________________________________
+void HighlightProfileDialog::_setEnabled( bool value )
+{
+    Debug::Throw( QStringLiteral("HighlightProfileDialog::_setEnabled.\n") );
+    HighlightProfiler::setEnabled( value );
+}
+
+//________________________________________________________
+void HighlightProfileDialog::_reset()
+{
+    Debug::Throw( QStringLiteral("HighlightProfileDialog::_reset.\n") );
+    HighlightProfiler::blockCounters().reset();
+    for( const auto& documentClass:Base::Singleton::get().application<Application>()->classManager().classes() )
+    {
+        for( const auto& pattern:documentClass.highlightPatterns() )
+        { pattern.resetStatistics(); }
+    }
+
+    _update();
+}
+
+//________________________________________________________
+void HighlightProfileDialog::_save()
+{
+
+    Debug::Throw( QStringLiteral("HighlightProfileDialog::_save.\n") );
+
+    FileDialog dialog( this );
+    dialog.setAcceptMode( QFileDialog::AcceptSave );
+    dialog.setFileMode( QFileDialog::AnyFile );
+
+    File file( dialog.getFile() );
+    if( file.isEmpty() ) return;
+
+    QFile out( file );
+    if( !out.open( QIODevice::WriteOnly|QIODevice::Text ) )
+    {
+        InformationDialog( this, tr( "Cannot write to file '%1'." ).arg( file ) ).exec();
+        return;
+    }
+
+    // tab separated values, with a header line
+    _update();
+    QTextStream stream( &out );
+    QStringList columns;
+    for( int column = 0; column < HighlightProfileModel::nColumns; ++column )
+    { columns.append( model_.columnTitle( column ) ); }
+    stream << columns.join( QLatin1Char( '\t' ) ) << Qt::endl;
+
+    for( const auto& profile:model_.get() )
+    {
+        columns.clear();
+        for( int column = 0; column < HighlightProfileModel::nColumns; ++column )
+        { columns.append( HighlightProfileModel::text( profile, column ) ); }
+        stream << columns.join( QLatin1Char( '\t' ) ) << Qt::endl;
+    }
+
+}
@@ -0,0 +1,86 @@
+#ifndef HighlightProfileDialog_h
+#define HighlightProfileDialog_h
+
+/******************************************************************************
+*
+* Copyright (C) 2002 Hugo PEREIRA <mailto: hugo.pereira@free.fr>
+*
+* This is free software; you can redistribute it and/or modify it under the
+* terms of the GNU General Public License as published by the Free Software
+* Foundation; either version 2 of the License, or (at your option) any later
+* version.
+*
+* This software is distributed in the hope that it will be useful, but WITHOUT
+* Any WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along with
+* this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*******************************************************************************/
+
+#include "Counter.h"
+#include "Dialog.h"
+#include "HighlightProfileModel.h"
+
+#include <QBasicTimer>
+#include <QTimerEvent>
+
+class QCheckBox;
+class TreeView;
+
+//* shows time spent in each highlight pattern, for all document classes
+class HighlightProfileDialog: public Dialog, private Base::Counter<HighlightProfileDialog>
+{
+
+    Q_OBJECT
+
+    public:
+
+    //* constructor
+    explicit HighlightProfileDialog( QWidget* = nullptr );
+
+    protected:
+
+    //* show event
+    void showEvent( QShowEvent* ) override;
+
+    //* hide event
+    void hideEvent( QHideEvent* ) override;
+
+    //* timer event
+    void timerEvent( QTimerEvent* ) override;
+
+    private:
+
+    //* update profiles from document classes
+    void _update();
+
+    //* enable profiling
+    void _setEnabled( bool );
+
+    //* reset counters
+    void _reset();
+
+    //* save profiles to file
+    void _save();
+
+    //* update interval (ms)
+    static const int updateInterval = 1000;
+
+    //* update timer
+    QBasicTimer timer_;
+
+    //* enable checkbox
+    QCheckBox* enableCheckBox_ = nullptr;
+
+    //* model
+    HighlightProfileModel model_;
+
+    //* list
+    TreeView* list_ = nullptr;
+
+};
+
+#endif
@@ -0,0 +1,111 @@
+/******************************************************************************
+*
+* Copyright (C) 2002 Hugo PEREIRA <mailto: hugo.pereira@free.fr>
+*
+* This is free software; you can redistribute it and/or modify it under the
+* terms of the GNU General Public License as published by the Free Software
+* Foundation; either version 2 of the License, or (at your option) any later
+* version.
+*
+* This software is distributed in the hope that it will be useful, but WITHOUT
+* Any WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along with
+* this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*******************************************************************************/
+
+#include "HighlightProfileModel.h"
+
+//__________________________________________________________________
+HighlightProfileModel::HighlightProfileModel( QObject* parent ):
+    ListModel(parent),
+    Counter( QStringLiteral("HighlightProfileModel") )
+{}
+
+//__________________________________________________________________
+Qt::ItemFlags HighlightProfileModel::flags( const QModelIndex& index ) const
+{
+    if( !contains( index ) ) return Qt::ItemFlags();
+    return Qt::ItemIsEnabled |  Qt::ItemIsSelectable;
+}
+
+//__________________________________________________________________
+QVariant HighlightProfileModel::data( const QModelIndex& index, int role ) const
+{
+
+    // check index
+    if( !contains( index ) ) return QVariant();
+
+    if( role == Qt::DisplayRole ) return text( get()[index.row()], index.column() );
+    else if( role == Qt::TextAlignmentRole && index.column() >= Invocations ) return int( Qt::AlignRight|Qt::AlignVCenter );
+    else return QVariant();
+
+}
+
+//__________________________________________________________________
+QVariant HighlightProfileModel::headerData(int section, Qt::Orientation, int role) const
+{
+
+    if(
+        role == Qt::DisplayRole &&
+        section >= 0 &&
+        section < nColumns )
+    { return columnTitles_[section]; }
+
+    // return empty
+    return QVariant();
+
+}
+
+//__________________________________________________________________
+QString HighlightProfileModel::text( const HighlightPatternProfile& profile, int column )
+{
+    switch( column )
+    {
+        case ClassName: return profile.className();
+        case Name: return profile.name();
+        case Invocations: return QString::number( profile.invocations() );
+        case Matches: return QString::number( profile.matches() );
+        case Time: return QString::number( double( profile.time() )/1e6, 'f', 1 );
+        case AverageTime: return QString::number( double( profile.averageTime() )/1e3, 'f', 1 );
+        case WorstTime: return QString::number( double( profile.worstTime() )/1e3, 'f', 1 );
+        case Skipped: return QString::number( profile.skipCount() );
+        case OverBudget: return QString::number( profile.overBudgetCount() );
+        default: return QString();
+    }
+}
+
+//____________________________________________________________
+void HighlightProfileModel::_sort( int column, Qt::SortOrder order )
+{
+
+    Debug::Throw() << "HighlightProfileModel::sort - column: " << column << " order: " << order << Qt::endl;
+    std::sort( _get().begin(), _get().end(), SortFTor( (ColumnType) column, order ) );
+
+}
+
+//________________________________________________________
+bool HighlightProfileModel::SortFTor::operator () ( const HighlightPatternProfile& constFirst, const HighlightPatternProfile& constSecond ) const
+{
+
+    HighlightPatternProfile first( constFirst );
+    HighlightPatternProfile second( constSecond );
+    if( order_ == Qt::DescendingOrder ) std::swap( first, second );
+    switch( type_ )
+    {
+        case ClassName: return first.className() < second.className();
+        case Name: return first.name() < second.name();
+        case Invocations: return first.invocations() < second.invocations();
+        case Matches: return first.matches() < second.matches();
+        case Time: return first.time() < second.time();
+        case AverageTime: return first.averageTime() < second.averageTime();
+        case WorstTime: return first.worstTime() < second.worstTime();
+        case Skipped: return first.skipCount() < second.skipCount();
+        case OverBudget: return first.overBudgetCount() < second.overBudgetCount();
+        default: return true;
+    }
+
+}
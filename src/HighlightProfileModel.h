@@ -0,0 +1,120 @@
+#ifndef HighlightProfileModel_h
+#define HighlightProfileModel_h
+
+/******************************************************************************
+*
+* Copyright (C) 2002 Hugo PEREIRA <mailto: hugo.pereira@free.fr>
+*
+* This is free software; you can redistribute it and/or modify it under the
+* terms of the GNU General Public License as published by the Free Software
+* Foundation; either version 2 of the License, or (at your option) any later
+* version.
+*
+* This software is distributed in the hope that it will be useful, but WITHOUT
+* Any WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along with
+* this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*******************************************************************************/
+
+#include "Counter.h"
+#include "HighlightProfiler.h"
+#include "ListModel.h"
+
+#include <array>
+
+//* highlight pattern profiling model
+class HighlightProfileModel : public ListModel<HighlightPatternProfile>, private Base::Counter<HighlightProfileModel>
+{
+
+    //* Qt meta object declaration
+    Q_OBJECT;
+
+    public:
+
+    //* constructor
+    explicit HighlightProfileModel(QObject* = nullptr);
+
+    //* column type enumeration
+    enum ColumnType
+    {
+        ClassName,
+        Name,
+        Invocations,
+        Matches,
+        Time,
+        AverageTime,
+        WorstTime,
+        Skipped,
+        OverBudget,
+        nColumns
+    };
+
+    //*@name methods reimplemented from base class
+    //@{
+
+    //* flags
+    Qt::ItemFlags flags( const QModelIndex& ) const override;
+
+    // return data for a given index
+    QVariant data( const QModelIndex&, int ) const override;
+
+    //* header data
+    QVariant headerData( int, Qt::Orientation, int = Qt::DisplayRole) const override;
+
+    //* number of columns for a given index
+    int columnCount(const QModelIndex& = QModelIndex() ) const override
+    { return nColumns; }
+
+    //@}
+
+    //* text associated to profile and column
+    static QString text( const HighlightPatternProfile&, int );
+
+    //* column title
+    QString columnTitle( int column ) const
+    { return columnTitles_[column]; }
+
+    protected:
+
+    //* sort
+    void _sort( int, Qt::SortOrder ) override;
+
+    private:
+
+    //* list column names
+    const std::array<QString, nColumns> columnTitles_ =
+    {{
+        tr( "Type" ),
+        tr( "Pattern" ),
+        tr( "Blocks" ),
+        tr( "Matches" ),
+        tr( "Total (ms)" ),
+        tr( "Average (us)" ),
+        tr( "Worst (us)" ),
+        tr( "Skipped" ),
+        tr( "Over Budget" )
+    }};
+
+    //* used to sort profiles
+    class SortFTor: public ItemModel::SortFTor
+    {
+
+        public:
+
+        //* constructor
+        explicit SortFTor( int type, Qt::SortOrder order ):
+            ItemModel::SortFTor( type, order )
+        {}
+
+        //* prediction
+        bool operator() ( const HighlightPatternProfile&, const HighlightPatternProfile& ) const;
+
+    };
+
+};
+
+#endif
@@ -118,15 +118,12 @@ QDomElement HtmlHelper::_htmlNode( QDomDocument& document )
 
             // parse locations
             PatternLocation location;
-            PatternLocation::SetIterator iter( locations.get() );
-            iter.toBack();
             const PatternLocation::ContainsFTor ftor( index );
-            while( iter.hasPrevious() )
+            for( int locationIndex = locations.size()-1; locationIndex >= 0; --locationIndex )
             {
-                const PatternLocation& current( iter.previous() );
-                if( ftor( current ) )
+                if( ftor( locations[locationIndex] ) )
                 {
-                    location = current;
+                    location = locations[locationIndex];
                     break;
                 }
             }
@@ -157,8 +154,11 @@ QDomElement HtmlHelper::_htmlNode( QDomDocument& document )
                 if( location.isValid() )
                 {
 
+                    // retrieve style
+                    const auto& style( editor_->textHighlight().style( location ) );
+
                     // retrieve font format
-                    TextFormat::Flags format( location.fontFormat() );
+                    TextFormat::Flags format( style.fontFormat() );
                     QString buffer;
                     QTextStream formatStream( &buffer );
                     if( format & TextFormat::Underline ) formatStream << "Text-decoration: underline; ";
@@ -167,7 +167,7 @@ QDomElement HtmlHelper::_htmlNode( QDomDocument& document )
                     if( format & TextFormat::Strike ) formatStream << "Text-decoration: line-through; ";
 
                     // retrieve color
-                    const QColor& color = location.color();
+                    const QColor& color = style.color();
                     if( color.isValid() ) formatStream << "color: " << color.name() << "; ";
 
                     span.setAttribute( QStringLiteral("Style"), buffer );
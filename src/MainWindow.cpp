@@ -76,6 +76,7 @@
 #include <QPrinter>
 #include <QDomElement>
 #include <QDomDocument>
+#include <algorithm>
 
 //_____________________________________________________
 MainWindow::MainWindow(  QWidget* parent ):
@@ -172,10 +173,11 @@ MainWindow::MainWindow(  QWidget* parent ):
     statusbar_->addPermanentWidget( fileEditor_ = new ElidedLabel( statusbar_ ), 1 );
 
     // other labels
-    statusbar_->addLabels( 3, 0 );
+    statusbar_->addLabels( 4, 0 );
     statusbar_->label(0).setAlignment( Qt::AlignCenter );
     statusbar_->label(1).setAlignment( Qt::AlignCenter );
     statusbar_->label(2).setAlignment( Qt::AlignCenter );
+    statusbar_->label(3).setAlignment( Qt::AlignCenter );
     statusbar_->addClock();
 
     fileEditor_->setTextInteractionFlags( Qt::TextSelectableByMouse|Qt::TextSelectableByKeyboard );
@@ -614,17 +616,18 @@ void MainWindow::_updateConfiguration()
 
     // assign icons to file in open previous menu based on class manager
     auto&& recentFiles( Base::Singleton::get().application<Application>()->recentFiles() );
-    auto&& classManager(Base::Singleton::get().application<Application>()->classManager());
+    // only class headers are needed, so that classes are not fully parsed
+    const auto documentClasses( Base::Singleton::get().application<Application>()->classManager().classes() );
     for( const auto& record:recentFiles.records() )
     {
 
         // FileRecord& record( *iter );
         if( !record.hasProperty( FileRecordProperties::ClassName ) ) continue;
-        DocumentClass documentClass( classManager.get( record.property( FileRecordProperties::ClassName ) ) );
-        if( documentClass.icon().isEmpty() ) continue;
+        const auto iter = std::find_if( documentClasses.begin(), documentClasses.end(), DocumentClass::SameNameFTor( record.property( FileRecordProperties::ClassName ) ) );
+        if( iter == documentClasses.end() || iter->icon().isEmpty() ) continue;
 
         // set icon property and store in recentFiles list
-        recentFiles.get( record.file() ).addProperty( FileRecordProperties::Icon, documentClass.icon() );
+        recentFiles.get( record.file() ).addProperty( FileRecordProperties::Icon, iter->icon() );
 
     }
 
@@ -745,6 +748,13 @@ void MainWindow::_update( TextDisplay::UpdateFlags flags )
         else  statusbar_->label(0).clear();
     }
 
+    if( _hasStatusBar() && (flags & TextDisplay::MatchCount) )
+    {
+        const int matchCount( activeDisplay().textSelectionHighlight().matchCount() );
+        if( matchCount >= 0 ) statusbar_->label(3).setText( tr( "Matches: %1" ).arg( matchCount ) );
+        else statusbar_->label(3).clear();
+    }
+
     if( flags & TextDisplay::DisplayCount )
     {
         int displayCount = activeView_->independentDisplayCount();
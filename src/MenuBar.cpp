@@ -335,6 +335,7 @@ void MenuBar::_updateToolsMenu()
 
     action->setEnabled( enabled );
 
+    toolsMenu_->addAction( &Base::Singleton::get().application<Application>()->highlightProfileAction() );
 
 }
 
@@ -80,7 +80,7 @@ void PrintHelper::print( QPrinter* printer )
             QTextLayout::FormatRange formatRange;
             formatRange.start = pattern.position();
             formatRange.length = pattern.length();
-            formatRange.format = pattern.format();
+            formatRange.format = editor_->textHighlight().locationFormat( pattern );
             formatRanges.append( formatRange );
         }
 
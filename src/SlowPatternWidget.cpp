@@ -0,0 +1,43 @@
+/******************************************************************************
+*
+* Copyright (C) 2002 Hugo PEREIRA <mailto: hugo.pereira@free.fr>
+*
+* This is free software; you can redistribute it and/or modify it under the
+* terms of the GNU General Public License as published by the Free Software
+* Foundation; either version 2 of the License, or (at your option) any later
+* version.
+*
+* This software is distributed in the hope that it will be useful, but WITHOUT
+* Any WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along with
+* this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*******************************************************************************/
+
+#include "SlowPatternWidget.h"
+#include "Debug.h"
+
+//________________________________________________________
+SlowPatternWidget::SlowPatternWidget( QWidget* parent ):
+    MessageWidget( parent, MessageType::Warning )
+{
+
+    Debug::Throw( QStringLiteral("SlowPatternWidget::SlowPatternWidget.\n") );
+
+    addDefaultCloseButton();
+
+    // delete on hide
+    connect( this, &MessageWidget::hideAnimationFinished, this, &QObject::deleteLater );
+
+}
+
+//________________________________________________________
+void SlowPatternWidget::addPattern( const QString& pattern )
+{
+    if( patterns_.contains( pattern ) ) return;
+    patterns_.append( pattern );
+    setText( tr( "Syntax highlighting is too slow on some lines, and was disabled there for the following patterns: %1." ).arg( patterns_.join( QStringLiteral( ", " ) ) ) );
+}
@@ -0,0 +1,55 @@
+#ifndef SlowPatternWidget_h
+#define SlowPatternWidget_h
+
+/******************************************************************************
+*
+* Copyright (C) 2002 Hugo PEREIRA <mailto: hugo.pereira@free.fr>
+*
+* This is free software; you can redistribute it and/or modify it under the
+* terms of the GNU General Public License as published by the Free Software
+* Foundation; either version 2 of the License, or (at your option) any later
+* version.
+*
+* This software is distributed in the hope that it will be useful, but WITHOUT
+* Any WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along with
+* this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*******************************************************************************/
+
+#include "Key.h"
+#include "MessageWidget.h"
+
+#include <QStringList>
+
+//* warns that some highlight patterns exceeded their budget
+class SlowPatternWidget: public MessageWidget, public Base::Key
+{
+
+    //* Qt macro
+    Q_OBJECT
+
+    public:
+
+    //* constructor
+    explicit SlowPatternWidget( QWidget* = nullptr );
+
+    //*@ modifiers
+    //@{
+
+    //* add pattern name
+    void addPattern( const QString& );
+
+    //@}
+
+    private:
+
+    //* pattern names
+    QStringList patterns_;
+
+};
+
+#endif
@@ -34,6 +34,7 @@
 #include "GridLayout.h"
 #include "HighlightBlockData.h"
 #include "HighlightBlockFlags.h"
+#include "HighlightCache.h"
 #include "IconEngine.h"
 #include "IconNames.h"
 #include "InformationDialog.h"
@@ -42,6 +43,7 @@
 #include "QtUtil.h"
 #include "QuestionDialog.h"
 #include "Singleton.h"
+#include "SlowPatternWidget.h"
 #include "TextBlockRange.h"
 #include "TextDocument.h"
 #include "TextEditorMarginWidget.h"
@@ -57,6 +59,7 @@
 #include "XmlOptions.h"
 
 #if WITH_ASPELL
+#include "SpellCheckCache.h"
 #include "SpellDialog.h"
 #include "SuggestionMenu.h"
 #endif
@@ -69,6 +72,7 @@
 #include <QMenu>
 #include <QScrollBar>
 #include <QTextCodec>
+#include <QVector>
 
 #include <new>
 #include <numeric>
@@ -122,6 +126,10 @@ TextDisplay::TextDisplay( QWidget* parent ):
     // parenthesis highlight
     parenthesisHighlight_ = new ParenthesisHighlight( this );
 
+    // text selection highlight
+    textSelectionHighlight_ = new TextSelectionHighlight( this );
+    connect( textSelectionHighlight_, &TextSelectionHighlight::matchCountChanged, this, &TextDisplay::_updateMatchCount );
+
     // text indent
     textIndent_ = new TextIndent( this );
 
@@ -129,6 +137,9 @@ TextDisplay::TextDisplay( QWidget* parent ):
     blockDelimiterDisplay_ = new BlockDelimiterDisplay( this );
     connect( &textHighlight(), &TextHighlight::needSegmentUpdate, blockDelimiterDisplay_, &BlockDelimiterDisplay::needUpdate );
 
+    // slow patterns are reported once the current block is highlighted
+    connect( &textHighlight(), &TextHighlight::patternOverBudget, this, &TextDisplay::_showSlowPattern, Qt::QueuedConnection );
+
     // connections
     connect( this, &QTextEdit::selectionChanged, this, &TextDisplay::_selectionChanged );
     connect( this, &QTextEdit::cursorPositionChanged, this, &TextDisplay::_highlightParenthesis );
@@ -153,11 +164,14 @@ TextDisplay::TextDisplay( QWidget* parent ):
     // track contents changed for syntax highlighting
     connect( document(), &QTextDocument::contentsChange, this, QOverload<int,int,int>::of(&TextDisplay::_setBlockModified) );
     connect( document(), &QTextDocument::modificationChanged, this, &TextDisplay::_textModified );
+    connect( verticalScrollBar(), &QAbstractSlider::valueChanged, this, &TextDisplay::_updateVisibleBlocks );
+    connect( verticalScrollBar(), &QAbstractSlider::rangeChanged, this, &TextDisplay::_updateVisibleBlocks );
 
     // track configuration modifications
     connect( Base::Singleton::get().application<Application>(), &Application::configurationChanged, this, &TextDisplay::_updateConfiguration );
     connect( Base::Singleton::get().application<Application>(), &Application::spellCheckConfigurationChanged, this, QOverload<>::of( &TextDisplay::_updateSpellCheckConfiguration) );
     connect( Base::Singleton::get().application<Application>(), &Application::documentClassesChanged, this, &TextDisplay::updateDocumentClass );
+    connect( Base::Singleton::get().application<Application>(), &Application::documentClassModified, this, &TextDisplay::_documentClassModified );
     _updateConfiguration();
     _updateSpellCheckConfiguration();
 
@@ -308,6 +322,9 @@ void TextDisplay::synchronize( TextDisplay* other )
     // parenthesis
     parenthesisHighlight_->synchronize( other->parenthesisHighlight() );
 
+    // text selection
+    textSelectionHighlight_->synchronize( other->textSelectionHighlight() );
+
     // block delimiters and line numbers
     blockDelimiterDisplay_->synchronize( &other->blockDelimiterDisplay() );
 
@@ -459,13 +476,28 @@ void TextDisplay::setFile( File file, bool checkAutoSave )
 
         // get encoding
         auto codec( QTextCodec::codecForName( textEncoding_ ) );
-        setPlainText( codec->toUnicode(content) );
+        const auto text( codec->toUnicode(content) );
+
+        // use cached highlighting, if any. Lazy documents are not cached
+        const auto highlightCacheKey( textHighlight_->isLazy( text.size() ) ?
+            QByteArray():
+            HighlightCache::key( content, textEncoding_, Base::Singleton::get().application<Application>()->classManager().get( className() ) ) );
+        HighlightCache::Locations locations;
+        const bool cached( HighlightCache::find( highlightCacheKey, locations ) );
+        if( cached ) textHighlight_->setCachedLocations( locations );
+
+        setPlainText( text );
         in.close();
 
+        textHighlight_->setCachedLocations( HighlightCache::Locations() );
+
         // update flags
         setModified( false );
         _setIgnoreWarnings( false );
 
+        // otherwise, store highlighting once complete, for the next time the document is opened
+        if( !cached ) textHighlight_->setCacheKey( highlightCacheKey );
+
         Debug::Throw( QStringLiteral("TextDisplay::setFile - content set.\n") );
 
     }
@@ -665,6 +697,9 @@ void TextDisplay::save()
     if( contentsChanged )
     {
 
+        // highlighting no longer matches the file contents
+        textHighlight_->setCacheKey( QByteArray() );
+
         // make backup
         if( XmlOptions::get().get<bool>( QStringLiteral("BACKUP") ) && file_.exists() ) file_.backup();
 
@@ -1101,6 +1136,7 @@ void TextDisplay::_updateDocumentClass( const File &file, bool newDocument )
     textIndent_->clear();
     textIndent_->setBaseIndentation(0);
     _clearMacros();
+    textHighlight_->setCacheKey( QByteArray() );
 
     // default document class is empty
     DocumentClass documentClass;
@@ -1151,6 +1187,39 @@ void TextDisplay::_updateDocumentClass( const File &file, bool newDocument )
         if( documentClass.tabSize() > 0 ) _setTabSize( documentClass.tabSize() );
     }
 
+    // patterns, styles, indentation and macros
+    _applyDocumentClass( documentClass );
+
+    // add information to Menu
+    if( !( file.isEmpty() || newDocument ) )
+    {
+        auto& record( _recentFiles().get( file ) );
+        record.addProperty( classNamePropertyId_, className() );
+        record.addProperty( wrapPropertyId_, QString::number( wrapModeAction().isChecked() ) );
+        if( !documentClass.icon().isEmpty() ) record.addProperty( iconPropertyId_, documentClass.icon() );
+    }
+
+    // rehighlight text entirely
+    // because Pattern Ids may have changed even if the className has not changed.
+    #if WITH_ASPELL
+    if( textHighlight_->isHighlightEnabled() && !textHighlight_->spellParser().isEnabled() ) rehighlight();
+    #else
+    if( textHighlight_->isHighlightEnabled() ) rehighlight();
+    #endif
+
+    // propagate
+    emit needUpdate( DocumentClassFlag );
+
+    return;
+
+}
+
+//___________________________________________________________________________
+void TextDisplay::_applyDocumentClass( const DocumentClass& documentClass )
+{
+
+    Debug::Throw( QStringLiteral("TextDisplay::_applyDocumentClass\n") );
+
     // enable actions consequently
     parenthesisHighlightAction_->setVisible( !documentClass.parenthesis().empty() );
     textHighlightAction_->setVisible( !documentClass.highlightPatterns().empty() );
@@ -1158,7 +1227,8 @@ void TextDisplay::_updateDocumentClass( const File &file, bool newDocument )
     baseIndentAction_->setVisible( documentClass.baseIndentation() );
 
     // store into class members
-    textHighlight_->setPatterns( documentClass.highlightPatterns() );
+    textHighlight_->setPatterns( documentClass.highlightPatternSet() );
+    textHighlight_->setStyles( documentClass.highlightStyleTable() );
     textHighlight_->setParenthesis( documentClass.parenthesis() );
     textHighlight_->setBlockDelimiters( documentClass.blockDelimiters() );
 
@@ -1183,28 +1253,39 @@ void TextDisplay::_updateDocumentClass( const File &file, bool newDocument )
         textHighlight_->parenthesisHighlightColor().isValid() &&
         !textHighlight_->parenthesis().empty() );
 
-    // add information to Menu
-    if( !( file.isEmpty() || newDocument ) )
-    {
-        auto& record( _recentFiles().get( file ) );
-        record.addProperty( classNamePropertyId_, className() );
-        record.addProperty( wrapPropertyId_, QString::number( wrapModeAction().isChecked() ) );
-        if( !documentClass.icon().isEmpty() ) record.addProperty( iconPropertyId_, documentClass.icon() );
-    }
+}
 
-    // rehighlight text entirely
-    // because Pattern Ids may have changed even if the className has not changed.
+//___________________________________________________________________________
+void TextDisplay::_documentClassModified( const QString& name )
+{
+
+    if( name != className() ) return;
+    Debug::Throw() << "TextDisplay::_documentClassModified - name: " << name << Qt::endl;
+
+    // highlighting to be cached does not match the new class
+    textHighlight_->setCacheKey( QByteArray() );
+
+    _applyDocumentClass( Base::Singleton::get().application<Application>()->classManager().get( name ) );
+
+    // rehighlight text entirely, in background
+    // blocks keep their current formats until new locations are available, visible blocks first
+    bool highlight( textHighlight_->isHighlightEnabled() );
     #if WITH_ASPELL
-    if( textHighlight_->isHighlightEnabled() && !textHighlight_->spellParser().isEnabled() ) rehighlight();
-    #else
-    if( textHighlight_->isHighlightEnabled() ) rehighlight();
+    highlight &= !textHighlight_->spellParser().isEnabled();
     #endif
 
+    if( highlight )
+    {
+        for( const auto& block:TextBlockRange( document() ) )
+        { _setBlockModified( block ); }
+
+        _updateVisibleBlocks();
+        textHighlight_->rehighlightInBackground();
+    }
+
     // propagate
     emit needUpdate( DocumentClassFlag );
 
-    return;
-
 }
 
 //_____________________________________________
@@ -1212,11 +1293,8 @@ void TextDisplay::find( const TextSelection& selection )
 {
     TextEditor::find( selection );
 
-    // also update text highlight
-    if( textHighlight_ && textHighlight_->updateTextSelection( selection ) )
-    {
-        textHighlight_->rehighlight();
-    }
+    // also update highlighted matches
+    textSelectionHighlight_->setTextSelection( selection );
 }
 
 //_____________________________________________
@@ -1244,6 +1322,7 @@ void TextDisplay::rehighlight()
     for( const auto& block:TextBlockRange( document() ) )
     { _setBlockModified( block ); }
 
+    _updateVisibleBlocks();
     textHighlight_->rehighlight();
 }
 
@@ -1513,8 +1592,15 @@ bool TextDisplay::_autoSpellContextEvent( QContextMenuEvent* event )
     connect( &menu, &SpellCheck::SuggestionMenu::ignoreWord, this, &TextDisplay::_ignoreMisspelledWord );
     connect( &menu, &SpellCheck::SuggestionMenu::suggestionSelected, this, &TextDisplay::_replaceMisspelledSelection );
 
+    // apart from suggestions and ignore, the only menu action adds the word to the personal dictionary
+    bool wordHandled( false );
+    auto setWordHandled = [&wordHandled]() { wordHandled = true; };
+    connect( &menu, &SpellCheck::SuggestionMenu::ignoreWord, this, setWordHandled );
+    connect( &menu, &SpellCheck::SuggestionMenu::suggestionSelected, this, setWordHandled );
+
     // execute
-    menu.exec( event->globalPos() );
+    // cached misspelled words are outdated only if the word was added to the personal dictionary
+    if( menu.exec( event->globalPos() ) && !wordHandled ) SpellCheckCache::clear();
     return true;
 
     #else
@@ -1919,13 +2005,15 @@ void TextDisplay::_updateConfiguration()
 
     // syntax highlighting
     textHighlightAction_->setChecked( XmlOptions::get().get<bool>( QStringLiteral("TEXT_HIGHLIGHT") ) );
+    textHighlight_->setAsynchronous( XmlOptions::get().get<bool>( QStringLiteral("HIGHLIGHT_ASYNCHRONOUS") ) );
+    textHighlight_->setLazySize( XmlOptions::get().get<int>( QStringLiteral("HIGHLIGHT_LAZY_SIZE") ) << 20 );
 
     // parenthesis highlight
     textHighlight_->setParenthesisHighlightColor( XmlOptions::get().get<Base::Color>( QStringLiteral("PARENTHESIS_COLOR") ) );
     parenthesisHighlightAction_->setChecked( XmlOptions::get().get<bool>( QStringLiteral("TEXT_PARENTHESIS") ) );
 
     // text selection
-    textHighlight_->setTextSelectionHighlightColor( XmlOptions::get().get<Base::Color>( QStringLiteral("TEXTSELECTION_HIGHLIGHT_COLOR") ) );
+    textSelectionHighlight_->setColor( XmlOptions::get().get<Base::Color>( QStringLiteral("TEXTSELECTION_HIGHLIGHT_COLOR") ) );
 
     // block delimiters, line numbers and margin
     showBlockDelimiterAction_->setChecked( XmlOptions::get().get<bool>( QStringLiteral("SHOW_BLOCK_DELIMITERS") ) );
@@ -2226,6 +2314,10 @@ void TextDisplay::_spellcheck()
 
     textHighlight_->spellParser().interface().mergeIgnoredWords( dialog.interface().ignoredWords() );
 
+    // words might have been added to the personal dictionary
+    SpellCheckCache::clear();
+    if( textHighlight_->spellParser().isEnabled() ) rehighlight();
+
     #endif
 
 }
@@ -2495,14 +2587,29 @@ void TextDisplay::_fileProperties()
 }
 
 //_____________________________________________________________
-void TextDisplay::_setBlockModified( int position, int, int added )
+void TextDisplay::_setBlockModified( int position, int removed, int added )
 {
     for( const auto& block:TextBlockRange(
         document()->findBlock( position ),
         document()->findBlock( position + added ).next() ) )
     { _setBlockModified( block ); }
+
+    textSelectionHighlight_->setContentsChanged( position, removed, added );
+}
+
+//__________________________________________________
+void TextDisplay::_updateVisibleBlocks()
+{
+    const auto first( cursorForPosition( QPoint( 0, 0 ) ).block() );
+    const auto last( cursorForPosition( QPoint( 0, viewport()->height() ) ).block() );
+    textHighlight_->setVisibleBlocks( first.blockNumber(), last.blockNumber() );
+    textSelectionHighlight_->update();
 }
 
+//__________________________________________________
+void TextDisplay::_updateMatchCount()
+{ if( isActive() ) emit needUpdate( MatchCount ); }
+
 //__________________________________________________
 void TextDisplay::_textModified()
 {
@@ -2575,9 +2682,10 @@ void TextDisplay::_highlightParenthesis()
 
     // check against opening parenthesis
     bool found( false );
+    int length( 0 );
     auto iter( std::find_if(
         parenthesis.begin(), parenthesis.end(),
-        TextParenthesis::FirstElementFTor( text.left( position ) ) ) );
+        TextParenthesis::FirstElementFTor( text, position ) ) );
 
     QRegularExpressionMatch match;
 
@@ -2625,6 +2733,7 @@ void TextDisplay::_highlightParenthesis()
                     {
                         // increment position
                         position = match.capturedStart();
+                        length = match.capturedLength();
                         found = true;
                         break;
                     }
@@ -2649,10 +2758,18 @@ void TextDisplay::_highlightParenthesis()
     }
 
     // if not found, check against closing parenthesis
+    // matching parenthesis are searched backward, using their position and contribution to the parenthesis count
+    struct Match
+    {
+        int position;
+        int length;
+        int increment;
+    };
+
     if( !( found || (iter =
         std::find_if(
         parenthesis.begin(), parenthesis.end(),
-        TextParenthesis::SecondElementFTor( text.left( position ) ) )) == parenthesis.end()  ) )
+        TextParenthesis::SecondElementFTor( text, position ) )) == parenthesis.end()  ) )
     {
 
         // store commented state
@@ -2685,17 +2802,32 @@ void TextDisplay::_highlightParenthesis()
             if( position < 0 ) position = text.length();
 
             // parse text
-            while( position >= 0 && (position = text.left( position ).lastIndexOf( iter->regexp(), -1, &match ) ) >= 0 )
+            // matches located before position are collected in a single forward pass, then processed backward.
+            // This avoids copying the text and searching it backward for each match, which is slow for long lines
+            QVector<Match> matches;
+            auto matchIter = iter->regexp().globalMatch( text );
+            while( matchIter.hasNext() )
             {
+                const auto current( matchIter.next() );
+                if( current.capturedEnd() > position ) break;
 
+                const auto captured( current.captured() );
+                if( captured == iter->first() ) matches.append( { current.capturedStart(), current.capturedLength(), -1 } );
+                else if( captured == iter->second() ) matches.append( { current.capturedStart(), current.capturedLength(), 1 } );
+                else matches.append( { current.capturedStart(), current.capturedLength(), 0 } );
+            }
+
+            for( auto riter = matches.crbegin(); riter != matches.crend(); ++riter )
+            {
+
+                position = riter->position;
                 if( isComment == locations.isCommented( position ) )
                 {
 
-                    if( match.captured() == iter->first() ) increment--;
-                    else if( match.captured() == iter->second() ) increment++;
-
+                    increment += riter->increment;
                     if( increment < 0 )
                     {
+                        length = riter->length;
                         found = true;
                         break;
                     }
@@ -2720,7 +2852,7 @@ void TextDisplay::_highlightParenthesis()
     // highlight
     if( found && position < block.length() )
     {
-        parenthesisHighlight_->highlight( position + block.position(), match.capturedLength() );
+        parenthesisHighlight_->highlight( position + block.position(), length );
         textHighlight_->rehighlightBlock( block );
     }
 
@@ -2863,6 +2995,30 @@ void TextDisplay::_clearTag()
 
 }
 
+//___________________________________________________________________________
+void TextDisplay::_showSlowPattern( const QString& pattern )
+{
+    Debug::Throw() << "TextDisplay::_showSlowPattern - pattern: " << pattern << Qt::endl;
+
+    // update existing widget, if any
+    Base::KeySet<SlowPatternWidget> widgets( this );
+    if( !widgets.empty() )
+    {
+        (*widgets.begin())->addPattern( pattern );
+        return;
+    }
+
+    // get parent textview
+    Base::KeySet<TextView> textViews( this );
+    if( textViews.empty() ) return;
+
+    auto widget = new SlowPatternWidget;
+    widget->addPattern( pattern );
+    (*textViews.begin())->addMessageWidget( widget );
+    Base::Key::associate( this, widget );
+    widget->animatedShow();
+}
+
 //___________________________________________________________________________
 void TextDisplay::_processFileRemovedAction( FileRemovedWidget::ReturnCode action )
 {
@@ -38,6 +38,7 @@
 #include "TextEditor.h"
 #include "TextIndent.h"
 #include "TextMacro.h"
+#include "TextSelectionHighlight.h"
 #include "TimeStamp.h"
 
 #if WITH_ASPELL
@@ -206,14 +207,17 @@ class TextDisplay: public TextEditor
         //* display count
         DisplayCount = 1<<10,
 
+        //* text selection match count
+        MatchCount = 1<<11,
+
         //* active file changed
-        ActiveDisplayChanged = FileName|DocumentClassFlag|ReadOnly|Cut|Copy|Paste|UndoRedo|SpellCheck|Modifiers,
+        ActiveDisplayChanged = FileName|DocumentClassFlag|ReadOnly|Cut|Copy|Paste|UndoRedo|SpellCheck|Modifiers|MatchCount,
 
         //* active file changed
-        ActiveViewChanged = FileName|DocumentClassFlag|ReadOnly|Cut|Copy|Paste|UndoRedo|SpellCheck|Modifiers|DisplayCount,
+        ActiveViewChanged = FileName|DocumentClassFlag|ReadOnly|Cut|Copy|Paste|UndoRedo|SpellCheck|Modifiers|DisplayCount|MatchCount,
 
         //* all the above
-        All = FileName|Modified|ReadOnly|Cut|Copy|Paste|UndoRedo|SpellCheck|Modifiers|DisplayCount
+        All = FileName|Modified|ReadOnly|Cut|Copy|Paste|UndoRedo|SpellCheck|Modifiers|DisplayCount|MatchCount
 
     };
 
@@ -283,6 +287,10 @@ class TextDisplay: public TextEditor
     ParenthesisHighlight& parenthesisHighlight() const
     { return *parenthesisHighlight_; }
 
+    //* text selection highlight
+    TextSelectionHighlight& textSelectionHighlight() const
+    { return *textSelectionHighlight_; }
+
     //* tag block (with diff flag)
     void tagBlock( QTextBlock, int tag );
 
@@ -546,6 +554,12 @@ class TextDisplay: public TextEditor
     //* track text modifications for syntax highlighting
     void _setBlockModified( int, int, int );
 
+    //* send visible blocks to syntax highlighter and text selection highlight
+    void _updateVisibleBlocks();
+
+    //* text selection match count
+    void _updateMatchCount();
+
     //* update action status
     void _updateSelectionActions( bool state ) override
     {
@@ -587,6 +601,9 @@ class TextDisplay: public TextEditor
     //* clear current block tags
     void _clearTag();
 
+    //* show highlight pattern that exceeded its budget
+    void _showSlowPattern( const QString& );
+
     //* process file removed action
     void _processFileRemovedAction( FileRemovedWidget::ReturnCode );
 
@@ -609,6 +626,12 @@ class TextDisplay: public TextEditor
     /** first parameter is file name, second tells if document is a new untitled document or not */
     void _updateDocumentClass( const File&, bool );
 
+    //* apply patterns, styles, indentation and macros from document class
+    void _applyDocumentClass( const DocumentClass& );
+
+    //* reload document class if it matches name, and rehighlight in background
+    void _documentClassModified( const QString& );
+
     //* set file name
     void _setFile( const File& file );
 
@@ -818,6 +841,9 @@ class TextDisplay: public TextEditor
     //* parenthesis highlight object
     ParenthesisHighlight* parenthesisHighlight_ = nullptr;
 
+    //* text selection highlight
+    TextSelectionHighlight* textSelectionHighlight_ = nullptr;
+
     //* block delimiter
     BlockDelimiterDisplay* blockDelimiterDisplay_ = nullptr;
 